@@ -61,29 +61,59 @@ public:
     /// @param anchors - vector of anchors coordinates. Required for YOLOv4, for other versions it may be omitted.
     /// @param masks - vector of masks values. Required for YOLOv4, for other versions it may be omitted.
     /// @param layout - model input layout
+    /// @param maxDetectionsPerClass - limit of boxes kept per class by NMS of in-graph postprocessing.
+    /// The default value is 100
     ModelYolo(const std::string& modelFileName, float confidenceThreshold, bool useAutoResize,
         bool useAdvancedPostprocessing = true, float boxIOUThreshold = 0.5, const std::vector<std::string>& labels = std::vector<std::string>(),
         const std::vector<float>& anchors = std::vector<float>(), const std::vector<int64_t>& masks = std::vector<int64_t>(),
-        const std::string& layout = "");
+        const std::string& layout = "", int64_t maxDetectionsPerClass = 100);
 
     std::unique_ptr<ResultBase> postprocess(InferenceResult& infResult) override;
 
+    /// Enables box decoding and NMS inside the compiled model, so postprocess() only copies out
+    /// the short list of selected boxes, gathered on the device. Supported for all YOLO versions except YOLOF.
+    /// NMS is done by NonMaxSuppression op, so useAdvancedPostprocessing is ignored in this mode.
+    /// Should be called before the model is compiled.
+    /// @param enable - if true, in-graph postprocessing will be used
+    void setInGraphPostprocessing(bool enable) { useInGraphPostprocessing = enable; }
+
 protected:
     void prepareInputsOutputs(std::shared_ptr<ov::Model>& model) override;
+    void appendPostprocessingToGraph(std::shared_ptr<ov::Model>& model);
+    std::unique_ptr<ResultBase> postprocessInGraph(InferenceResult& infResult);
 
     void parseYOLOOutput(const std::string& output_name, const ov::Tensor& tensor,
         const unsigned long resized_im_h, const unsigned long resized_im_w, const unsigned long original_im_h,
         const unsigned long original_im_w, std::vector<DetectedObject>& objects);
 
-    static int calculateEntryIndex(int entriesNum, int lcoords, size_t lclasses, int location, int entry);
+    /// Pointer to a decoder of one region output, see decodeRegion().
+    template <typename T>
+    using RegionDecoder = void (ModelYolo::*)(const Region& region, const T* outData, int sideH, int sideW,
+        float scaleH, float scaleW, float originalImH, float originalImW, std::vector<DetectedObject>& objects);
+
+    /// Decodes region data of output element type T (float or ov::float16).
+    /// YOLO version, presence of objectness and output layout are compile-time parameters,
+    /// so the inner loops have no runtime branches. Only the elements actually read are converted to f32.
+    template <typename T, YoloVersion version, bool hasObjConf, bool isNHWC>
+    void decodeRegion(const Region& region, const T* outData, int sideH, int sideW,
+        float scaleH, float scaleW, float originalImH, float originalImW, std::vector<DetectedObject>& objects);
+
+    /// Selects decodeRegion() specialization matching yoloVersion, isObjConf and yoloRegionLayout.
+    template <typename T>
+    RegionDecoder<T> selectRegionDecoder() const;
+
     static double intersectionOverUnion(const DetectedObject& o1, const DetectedObject& o2);
 
     std::map<std::string, Region> regions;
     double boxIOUThreshold;
+    int64_t maxDetectionsPerClass;
     bool useAdvancedPostprocessing;
     bool isObjConf = 1;
     YoloVersion yoloVersion;
     const std::vector<float> presetAnchors;
     const std::vector<int64_t> presetMasks;
     ov::Layout yoloRegionLayout = "NCHW";
+    bool useInGraphPostprocessing = false;
+    RegionDecoder<float> decodeRegionF32 = nullptr;
+    RegionDecoder<ov::float16> decodeRegionF16 = nullptr;
 };
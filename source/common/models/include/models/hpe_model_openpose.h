@@ -58,6 +58,7 @@ protected:
 
     std::vector<HumanPose> extractPoses(const std::vector<cv::Mat>& heatMaps,
                                         const std::vector<cv::Mat>& pafs) const;
+    static std::vector<cv::Mat> wrapFeatureMaps(const ov::Tensor& tensor, size_t count);
     void resizeFeatureMaps(std::vector<cv::Mat>& featureMaps) const;
 
     void changeInputSize(std::shared_ptr<ov::Model>& model);
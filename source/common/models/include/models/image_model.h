@@ -29,8 +29,18 @@ public:
 
     virtual std::shared_ptr<InternalModelData> preprocess(const InputData& inputData, ov::InferRequest& request) override;
 
+    /// Makes the model take NV12 frames (see nv12Size() of utils/image_utils.h) as two planes,
+    /// converted to BGR and resized inside the compiled model. Must be set before the model is loaded
+    void setNV12Input(bool nv12) { nv12Input = nv12; }
+
 protected:
+    /// Declares the image input as NV12 in two planes of any size, converted to BGR and resized to the model input.
+    /// Called by prepareInputsOutputs() of models supporting NV12, before other preprocessing steps of the input
+    void addNV12Input(ov::preprocess::PrePostProcessor& ppp, const std::string& inputName);
+
     bool useAutoResize;
+    bool nv12Input = false;
+    std::vector<std::string> nv12InputsNames;  ///< Y and UV planes of the image input, empty if the model takes BGR
 
     size_t netInputHeight = 0;
     size_t netInputWidth = 0;
@@ -0,0 +1,95 @@
+/*
+// Copyright (C) 2020-2022 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+#pragma once
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <openvino/openvino.hpp>
+#include "models/model_base.h"
+
+/// Forwards preprocessing and postprocessing to the wrapped model, so a wrapper changes only how the model
+/// is compiled or what happens around its inference
+class ModelWrapper : public ModelBase {
+public:
+    explicit ModelWrapper(std::unique_ptr<ModelBase>&& model);
+
+    std::shared_ptr<InternalModelData> preprocess(const InputData& inputData, ov::InferRequest& request) override {
+        return wrapped->preprocess(inputData, request);
+    }
+    ov::CompiledModel compileModel(const ModelConfig& config, ov::Core& core) override;
+    void onLoadCompleted(const std::vector<ov::InferRequest>& requests) override { wrapped->onLoadCompleted(requests); }
+    std::unique_ptr<ResultBase> postprocess(InferenceResult& infResult) override { return wrapped->postprocess(infResult); }
+
+protected:
+    void prepareInputsOutputs(std::shared_ptr<ov::Model>& model) override {}
+    /// Takes names of inputs and outputs from the wrapped model, once it is prepared
+    void copyNames();
+
+    std::unique_ptr<ModelBase> wrapped;
+};
+
+/// Delay of a mock inference
+class MockDelay {
+public:
+    /// @param spec - "<ms>" for a fixed delay, "uniform:<min>:<max>", "normal:<mean>:<stddev>" or "exponential:<mean>", in ms
+    explicit MockDelay(const std::string& spec);
+
+    /// Thread safe, every thread draws from its own generator
+    std::chrono::duration<double, std::milli> sample() const;
+
+private:
+    enum class Distribution {Fixed, Uniform, Normal, Exponential};
+    Distribution distribution;
+    double a;
+    double b;
+};
+
+/// Replaces inference of the wrapped model with a mock, to measure the cost of the pipeline around inference
+/// without the target device. The wrapped model is read and prepared as usual, then a model with the same
+/// inputs and outputs is compiled for CPU in its place. Its only operation sleeps for a delay drawn from
+/// the distribution and returns canned outputs, so preprocessing, infer requests, callbacks and postprocessing
+/// all run as with the real model. Requests run concurrently up to the number of CPU streams in the config.
+class MockModel : public ModelWrapper {
+public:
+    /// @param delay - delay distribution, see MockDelay
+    /// @param outputsFileName - canned outputs written by OutputsRecorder. Outputs are zeros if it is empty
+    MockModel(std::unique_ptr<ModelBase>&& model, const std::string& delay, const std::string& outputsFileName = "");
+
+    /// Compiles the mock for CPU, config should be made for CPU
+    ov::CompiledModel compileModel(const ModelConfig& config, ov::Core& core) override;
+
+    /// Writes outputs in the format read by MockModel
+    static void saveOutputs(const std::map<std::string, ov::Tensor>& outputs, const std::string& fileName);
+    static std::map<std::string, ov::Tensor> loadOutputs(const std::string& fileName);
+
+private:
+    MockDelay delay;
+    std::string outputsFileName;
+};
+
+/// Runs the wrapped model and writes raw outputs of the first inferred frame, to be used as canned outputs of MockModel
+class OutputsRecorder : public ModelWrapper {
+public:
+    OutputsRecorder(std::unique_ptr<ModelBase>&& model, const std::string& outputsFileName);
+
+    std::unique_ptr<ResultBase> postprocess(InferenceResult& infResult) override;
+
+private:
+    std::string outputsFileName;
+    bool recorded = false;
+};
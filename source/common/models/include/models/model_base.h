@@ -39,16 +39,38 @@ public:
 
     std::string getModelFileName() { return modelFileName; }
 
+    /// Reads the model and applies preprocessing and outputs settings without compiling it,
+    /// so that a substitute with the same inputs and outputs can be compiled instead, see MockModel
+    std::shared_ptr<ov::Model> readModel(const ModelConfig& config, ov::Core& core) {
+        this->config = config;
+        return prepareModel(core);
+    }
+
     void setInputsPreprocessing(bool reverseInputChannels, const std::string &meanValues, const std::string &scaleValues) {
         this->inputTransform = InputTransform(reverseInputChannels, meanValues, scaleValues);
     }
 
+    /// Sets element type of output tensors for models which parse f16 outputs natively
+    /// (YOLO with C++ postprocessing and segmentation). Other models keep f32 outputs.
+    /// f16 avoids conversion of large output maps on devices computing in f16.
+    /// @param precision - "f32" or "f16"
+    void setOutputsPrecision(const std::string& precision) {
+        if (precision == "f32") {
+            outputsPrecision = ov::element::f32;
+        } else if (precision == "f16") {
+            outputsPrecision = ov::element::f16;
+        } else {
+            throw std::runtime_error("Unsupported outputs precision \"" + precision + "\", only f32 and f16 are supported");
+        }
+    }
+
 protected:
     virtual void prepareInputsOutputs(std::shared_ptr<ov::Model>& model) = 0;
 
     std::shared_ptr<ov::Model> prepareModel(ov::Core& core);
 
     InputTransform inputTransform = InputTransform();
+    ov::element::Type outputsPrecision = ov::element::f32;
     std::vector<std::string> inputsNames;
     std::vector<std::string> outputsNames;
     ov::CompiledModel compiledModel;
@@ -79,6 +79,7 @@ struct DetectedObject : public cv::Rect2f {
     unsigned int labelID;
     std::string label;
     float confidence;
+    std::vector<ClassificationResult::Classification> topLabels;  // filled by classification of the object ROI, if any
 };
 
 struct DetectionResult : public ResultBase {
@@ -41,10 +41,12 @@ void ModelCenterNet::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
     }
 
     ov::preprocess::PrePostProcessor ppp(model);
-    inputTransform.setPrecision(ppp, model->input().get_any_name());
     ppp.input().tensor().
+        set_element_type(ov::element::u8).
         set_layout("NHWC");
 
+    inputTransform.setPreprocessing(ppp, model->input().get_any_name());
+
     ppp.input().model().set_layout(inputLayout);
 
     // --------------------------- Reading image input parameters -------------------------------------------
@@ -113,9 +115,10 @@ cv::Mat getAffineTransform(float centerX, float centerY, int srcW, float rot, si
 
 std::shared_ptr<InternalModelData> ModelCenterNet::preprocess(const InputData& inputData, ov::InferRequest& request) {
     auto& img = inputData.asRef<ImageInputData>().inputImage;
-    const auto& resizedImg = resizeImageExt(img, netInputWidth, netInputHeight, RESIZE_KEEP_ASPECT_LETTERBOX);
+    // Letterbox straight into the request tensor to avoid intermediate copies
+    cv::Mat resizedImg = wrapTensor2Mat(request.get_input_tensor());
+    resizeImageExt(img, resizedImg, RESIZE_KEEP_ASPECT_LETTERBOX);
 
-    request.set_input_tensor(wrapMat2Tensor(inputTransform(resizedImg)));
     return std::make_shared<InternalImageModelData>(img.cols, img.rows);
 }
 
@@ -42,8 +42,8 @@ void ModelFaceBoxes::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
     }
 
     ov::preprocess::PrePostProcessor ppp(model);
-    inputTransform.setPrecision(ppp, model->input().get_any_name());
     ppp.input().tensor().
+        set_element_type(ov::element::u8).
         set_layout({ "NHWC" });
 
     if (useAutoResize) {
@@ -55,6 +55,8 @@ void ModelFaceBoxes::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
             resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR);
     }
 
+    inputTransform.setPreprocessing(ppp, model->input().get_any_name());
+
     ppp.input().model().set_layout(inputLayout);
 
     // --------------------------- Reading image input parameters -------------------------------------------
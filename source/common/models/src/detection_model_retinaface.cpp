@@ -57,6 +57,8 @@ void ModelRetinaFace::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
             resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR);
     }
 
+    inputTransform.setPreprocessing(ppp, model->input().get_any_name());
+
     ppp.input().model().set_layout(inputLayout);
 
     // --------------------------- Reading image input parameters -------------------------------------------
@@ -149,8 +149,8 @@ void ModelSSD::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
                 inputsNames[0] = inputTensorName;
             }
 
-            inputTransform.setPrecision(ppp, inputTensorName);
             ppp.input(inputTensorName).tensor().
+                set_element_type(ov::element::u8).
                 set_layout({ "NHWC" });
 
             if (useAutoResize) {
@@ -162,6 +162,8 @@ void ModelSSD::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
                     resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR);
             }
 
+            inputTransform.setPreprocessing(ppp, inputTensorName);
+
             ppp.input(inputTensorName).model().set_layout(inputLayout);
 
             netInputWidth = shape[ov::layout::width_idx(inputLayout)];
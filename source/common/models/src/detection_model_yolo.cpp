@@ -15,9 +15,11 @@
 */
 
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <openvino/openvino.hpp>
 #include <openvino/op/region_yolo.hpp>
+#include <openvino/opsets/opset8.hpp>
 #include <utils/common.hpp>
 #include <utils/ocv_common.hpp>
 #include "models/detection_model_yolo.h"
@@ -59,17 +61,14 @@ static inline float sigmoid(float x) {
     return 1.f / (1.f + exp(-x));
 }
 
-static inline float linear(float x) {
-    return x;
-}
-
 
 ModelYolo::ModelYolo(const std::string& modelFileName, float confidenceThreshold, bool useAutoResize,
     bool useAdvancedPostprocessing, float boxIOUThreshold, const std::vector<std::string>& labels,
     const std::vector<float>& anchors, const std::vector<int64_t>& masks,
-    const std::string& layout) :
+    const std::string& layout, int64_t maxDetectionsPerClass) :
     DetectionModel(modelFileName, confidenceThreshold, useAutoResize, labels, layout),
     boxIOUThreshold(boxIOUThreshold),
+    maxDetectionsPerClass(maxDetectionsPerClass),
     useAdvancedPostprocessing(useAdvancedPostprocessing),
     yoloVersion(YOLO_V3),
     presetAnchors(anchors),
@@ -96,7 +95,9 @@ void ModelYolo::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
         set_element_type(ov::element::u8).
         set_layout({ "NHWC" });
 
-    if (useAutoResize) {
+    if (nv12Input) {
+        addNV12Input(ppp, model->input().get_any_name());
+    } else if (useAutoResize) {
         ppp.input().tensor().
             set_spatial_dynamic_shape();
 
@@ -105,10 +106,16 @@ void ModelYolo::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
             resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR);
     }
 
+    inputTransform.setPreprocessing(ppp, model->input().get_any_name());
+
     ppp.input().model().set_layout(inputLayout);
 
     //--- Reading image input parameters
-    inputsNames.push_back(model->input().get_any_name());
+    if (nv12Input) {
+        inputsNames = nv12InputsNames;
+    } else {
+        inputsNames.push_back(model->input().get_any_name());
+    }
     netInputWidth = inputShape[ov::layout::width_idx(inputLayout)];
     netInputHeight = inputShape[ov::layout::height_idx(inputLayout)];
 
@@ -116,7 +123,8 @@ void ModelYolo::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
     const ov::OutputVector& outputs = model->outputs();
     std::map<std::string, ov::Shape> outShapes;
     for (auto& out : outputs) {
-        ppp.output(out.get_any_name()).tensor().set_element_type(ov::element::f32);
+        // In-graph postprocessing appends f32 ops to the raw outputs, so they are kept in f32
+        ppp.output(out.get_any_name()).tensor().set_element_type(useInGraphPostprocessing ? ov::element::f32 : outputsPrecision);
         if (out.get_shape().size() == 4) {
             if (out.get_shape()[ov::layout::height_idx(yoloRegionLayout)] != out.get_shape()[ov::layout::width_idx(yoloRegionLayout)] &&
                 out.get_shape()[ov::layout::height_idx({ "NHWC" })] == out.get_shape()[ov::layout::width_idx({ "NHWC" })]) {
@@ -200,9 +208,131 @@ void ModelYolo::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
                 "This model is not YoloV4, so these options will be ignored." << slog::endl;
         }
     }
+
+    if (useInGraphPostprocessing) {
+        appendPostprocessingToGraph(model);
+    } else {
+        decodeRegionF32 = selectRegionDecoder<float>();
+        decodeRegionF16 = selectRegionDecoder<ov::float16>();
+    }
+}
+
+void ModelYolo::appendPostprocessingToGraph(std::shared_ptr<ov::Model>& model) {
+    namespace opset = ov::opset8;
+    if (yoloVersion == YOLOF) {
+        throw std::logic_error("In-graph postprocessing is not supported for YOLOF models");
+    }
+
+    const bool useSigmoid = yoloVersion == YOLO_V4 || yoloVersion == YOLO_V4_TINY;
+    auto activate = [useSigmoid](const ov::Output<ov::Node>& x) -> ov::Output<ov::Node> {
+        return useSigmoid ? std::make_shared<opset::Sigmoid>(x)->output(0) : x;
+    };
+
+    ov::OutputVector boxesParts;
+    ov::OutputVector scoresParts;
+    size_t classes = 0;
+    for (const auto& name : outputsNames) {
+        const auto& region = regions.at(name);
+        if (region.coords != 4) {
+            throw std::logic_error("In-graph postprocessing supports YOLO regions with 4 coordinates only");
+        }
+        if (classes && classes != region.classes) {
+            throw std::logic_error("In-graph postprocessing requires the same number of classes in every region");
+        }
+        classes = region.classes;
+
+        const int64_t num = region.num;
+        const int64_t cells = static_cast<int64_t>(region.outputWidth * region.outputHeight);
+        const float sideW = static_cast<float>(region.outputWidth);
+        const float sideH = static_cast<float>(region.outputHeight);
+
+        // Region outputs are consumed before the Result node, so the graph works on raw f32 maps
+        ov::Output<ov::Node> raw = model->output(name).get_node_shared_ptr()->input_value(0);
+        if (raw.get_shape().size() == 4 && yoloRegionLayout == ov::Layout("NHWC")) {
+            raw = std::make_shared<opset::Transpose>(raw,
+                opset::Constant::create(ov::element::i64, ov::Shape{4}, {0, 3, 1, 2}));
+        }
+
+        // [1, num * (5 + classes), H, W] -> [1, num, 5 + classes, H * W]
+        auto data = std::make_shared<opset::Reshape>(raw,
+            opset::Constant::create(ov::element::i64, ov::Shape{4},
+                std::vector<int64_t>{1, num, 5 + static_cast<int64_t>(classes), cells}), false);
+        auto parts = std::make_shared<opset::VariadicSplit>(data,
+            opset::Constant::create(ov::element::i64, ov::Shape{}, {2}),
+            opset::Constant::create(ov::element::i64, ov::Shape{4},
+                std::vector<int64_t>{2, 2, 1, static_cast<int64_t>(classes)}));
+
+        // --------------------------- Box decoding, coordinates are normalized to [0, 1] ---------------
+        std::vector<float> grid(2 * cells);
+        for (int64_t i = 0; i < cells; ++i) {
+            grid[i] = static_cast<float>(i % region.outputWidth);
+            grid[cells + i] = static_cast<float>(i / region.outputWidth);
+        }
+        const float scaleW = yoloVersion == YOLO_V1V2 ? sideW : static_cast<float>(netInputWidth);
+        const float scaleH = yoloVersion == YOLO_V1V2 ? sideH : static_cast<float>(netInputHeight);
+
+        auto center = std::make_shared<opset::Divide>(
+            std::make_shared<opset::Add>(activate(parts->output(0)),
+                opset::Constant::create(ov::element::f32, ov::Shape{1, 1, 2, static_cast<size_t>(cells)}, grid)),
+            opset::Constant::create(ov::element::f32, ov::Shape{1, 1, 2, 1}, {sideW, sideH}));
+        auto halfSize = std::make_shared<opset::Multiply>(
+            std::make_shared<opset::Multiply>(std::make_shared<opset::Exp>(parts->output(1)),
+                opset::Constant::create(ov::element::f32, ov::Shape{1, static_cast<size_t>(num), 2, 1}, region.anchors)),
+            opset::Constant::create(ov::element::f32, ov::Shape{1, 1, 2, 1}, {0.5f / scaleW, 0.5f / scaleH}));
+        auto corners = std::make_shared<opset::Concat>(ov::OutputVector{
+            std::make_shared<opset::Subtract>(center, halfSize),
+            std::make_shared<opset::Add>(center, halfSize)}, 2);
+        // [1, num, 4, H * W] -> [1, num * H * W, 4], box index is n * H * W + cell as in parseYOLOOutput
+        boxesParts.push_back(std::make_shared<opset::Reshape>(
+            std::make_shared<opset::Transpose>(corners,
+                opset::Constant::create(ov::element::i64, ov::Shape{4}, {0, 1, 3, 2})),
+            opset::Constant::create(ov::element::i64, ov::Shape{3}, std::vector<int64_t>{1, num * cells, 4}), false));
+
+        // --------------------------- Class confidences ------------------------------------------------
+        auto scores = std::make_shared<opset::Multiply>(activate(parts->output(2)), activate(parts->output(3)));
+        // [1, num, classes, H * W] -> [1, classes, num * H * W]
+        scoresParts.push_back(std::make_shared<opset::Reshape>(
+            std::make_shared<opset::Transpose>(scores,
+                opset::Constant::create(ov::element::i64, ov::Shape{4}, {0, 2, 1, 3})),
+            opset::Constant::create(ov::element::i64, ov::Shape{3},
+                std::vector<int64_t>{1, static_cast<int64_t>(classes), num * cells}), false));
+    }
+
+    auto boxes = std::make_shared<opset::Concat>(boxesParts, 1);
+    auto nms = std::make_shared<opset::NonMaxSuppression>(
+        boxes,
+        std::make_shared<opset::Concat>(scoresParts, 2),
+        opset::Constant::create(ov::element::i64, ov::Shape{}, {maxDetectionsPerClass}),
+        opset::Constant::create(ov::element::f32, ov::Shape{}, {static_cast<float>(boxIOUThreshold)}),
+        opset::Constant::create(ov::element::f32, ov::Shape{}, {confidenceThreshold}),
+        opset::NonMaxSuppression::BoxEncodingType::CORNER,
+        true,
+        ov::element::i32);
+
+    // Only the selected boxes are read back: [1, N, 4] boxes are gathered by the box column of selected indices
+    // into [M, 4]. Rows past the valid number may hold -1 indices, which Gather takes from the end, and are skipped
+    auto selectedBoxes = std::make_shared<opset::Gather>(
+        std::make_shared<opset::Squeeze>(boxes, opset::Constant::create(ov::element::i64, ov::Shape{1}, {0})),
+        std::make_shared<opset::Gather>(nms->output(0),
+            opset::Constant::create(ov::element::i64, ov::Shape{}, {2}),
+            opset::Constant::create(ov::element::i64, ov::Shape{}, {1})),
+        opset::Constant::create(ov::element::i64, ov::Shape{}, {0}));
+
+    outputsNames = { "yolo_nms_indices", "yolo_nms_scores", "yolo_nms_valid", "yolo_nms_boxes" };
+    ov::ResultVector results;
+    const ov::OutputVector resultsOutputs = { nms->output(0), nms->output(1), nms->output(2), selectedBoxes->output(0) };
+    for (size_t i = 0; i < resultsOutputs.size(); ++i) {
+        resultsOutputs[i].get_tensor().set_names({ outputsNames[i] });
+        results.push_back(std::make_shared<opset::Result>(resultsOutputs[i]));
+    }
+    model = std::make_shared<ov::Model>(results, model->get_parameters(), model->get_friendly_name());
 }
 
 std::unique_ptr<ResultBase> ModelYolo::postprocess(InferenceResult& infResult) {
+    if (useInGraphPostprocessing) {
+        return postprocessInGraph(infResult);
+    }
+
     DetectionResult* result = new DetectionResult(infResult.frameId, infResult.metaData);
     std::vector<DetectedObject> objects;
 
@@ -247,6 +377,38 @@ std::unique_ptr<ResultBase> ModelYolo::postprocess(InferenceResult& infResult) {
     return std::unique_ptr<ResultBase>(result);
 }
 
+std::unique_ptr<ResultBase> ModelYolo::postprocessInGraph(InferenceResult& infResult) {
+    DetectionResult* result = new DetectionResult(infResult.frameId, infResult.metaData);
+    auto retVal = std::unique_ptr<ResultBase>(result);
+
+    const auto& internalData = infResult.internalModelData->asRef<InternalImageModelData>();
+    const float imgWidth = static_cast<float>(internalData.inputImgWidth);
+    const float imgHeight = static_cast<float>(internalData.inputImgHeight);
+
+    // selected indices and scores are [M, 3] tensors of (batch, class, box) triplets, selected boxes are [M, 4]
+    const int32_t* indices = infResult.outputsData[outputsNames[0]].data<int32_t>();
+    const float* scores = infResult.outputsData[outputsNames[1]].data<float>();
+    const int32_t validNum = infResult.outputsData[outputsNames[2]].data<int32_t>()[0];
+    const float* boxes = infResult.outputsData[outputsNames[3]].data<float>();
+
+    result->objects.reserve(validNum);
+    for (int32_t i = 0; i < validNum; ++i) {
+        const float* box = boxes + i * 4;
+
+        DetectedObject obj;
+        obj.x = clamp(box[0] * imgWidth, 0.f, imgWidth);
+        obj.y = clamp(box[1] * imgHeight, 0.f, imgHeight);
+        obj.width = clamp((box[2] - box[0]) * imgWidth, 0.f, imgWidth - obj.x);
+        obj.height = clamp((box[3] - box[1]) * imgHeight, 0.f, imgHeight - obj.y);
+        obj.confidence = scores[i * 3 + 2];
+        obj.labelID = indices[i * 3 + 1];
+        obj.label = getLabelName(obj.labelID);
+        result->objects.push_back(obj);
+    }
+
+    return retVal;
+}
+
 void ModelYolo::parseYOLOOutput(const std::string& output_name,
     const ov::Tensor& tensor, const unsigned long resized_im_h,
     const unsigned long resized_im_w, const unsigned long original_im_h,
@@ -281,62 +443,140 @@ void ModelYolo::parseYOLOOutput(const std::string& output_name,
         break;
     }
 
-    auto entriesNum = sideW * sideH;
-    const float* outData = tensor.data<float>();
+    const ov::element::Type& type = tensor.get_element_type();
+    if (type == ov::element::f32) {
+        (this->*decodeRegionF32)(region, tensor.data<float>(), sideH, sideW,
+            static_cast<float>(scaleH), static_cast<float>(scaleW),
+            static_cast<float>(original_im_h), static_cast<float>(original_im_w), objects);
+    } else if (type == ov::element::f16) {
+        (this->*decodeRegionF16)(region, tensor.data<ov::float16>(), sideH, sideW,
+            static_cast<float>(scaleH), static_cast<float>(scaleW),
+            static_cast<float>(original_im_h), static_cast<float>(original_im_w), objects);
+    } else {
+        throw std::runtime_error("Unsupported element type of output " + output_name +
+            ", only f32 and f16 are supported");
+    }
+}
 
-    auto postprocessRawData = (yoloVersion == YOLO_V4 || yoloVersion == YOLO_V4_TINY || yoloVersion == YOLOF) ? sigmoid : linear;
+template <typename T, ModelYolo::YoloVersion version, bool hasObjConf, bool isNHWC>
+void ModelYolo::decodeRegion(const Region& region, const T* outData, int sideH, int sideW,
+    float scaleH, float scaleW, float originalImH, float originalImW, std::vector<DetectedObject>& objects) {
+    const bool useSigmoid = version == YOLO_V4 || version == YOLO_V4_TINY || version == YOLOF;
+    const int entriesNum = sideW * sideH;
+    const int entrySize = region.coords + static_cast<int>(region.classes) + (hasObjConf ? 1 : 0);
+    const int channelsNum = region.num * entrySize;
+    // Channel stride and cell stride of the output: [num * entrySize, H * W] for NCHW, [H * W, num * entrySize] for NHWC
+    const int channelStep = isNHWC ? 1 : entriesNum;
+    const int cellStep = isNHWC ? channelsNum : 1;
+
+    // f16 data is converted to f32 by convertToFloat() in contiguous runs: the objectness plane of an anchor
+    // for NCHW, the entry of a cell passing the objectness check for NHWC. Without objectness every value is read,
+    // so the whole anchor plane (NCHW) or every entry (NHWC) is converted.
+    const bool convert = !std::is_same<T, float>::value;
+    std::vector<float> anchorData(convert && !isNHWC ? (hasObjConf ? entriesNum : entrySize * entriesNum) : 0);
+    std::vector<float> entryData(convert ? entrySize : 0);
 
     // --------------------------- Parsing YOLO Region output -------------------------------------
-    for (int i = 0; i < entriesNum; ++i) {
-        int row = i / sideW;
-        int col = i % sideW;
-        for (int n = 0; n < region.num; ++n) {
+    for (int n = 0; n < region.num; ++n) {
+        const T* anchor = outData + n * entrySize * channelStep;
+        if (!anchorData.empty()) {
+            convertToFloat(anchor + (hasObjConf ? region.coords * channelStep : 0), anchorData.data(), anchorData.size());
+        }
+        for (int i = 0; i < entriesNum; ++i) {
+            const int row = i / sideW;
+            const int col = i % sideW;
             //--- Getting region data
-            int obj_index = calculateEntryIndex(entriesNum, region.coords, region.classes + isObjConf, n * entriesNum + i, region.coords);
-            int box_index = calculateEntryIndex(entriesNum, region.coords, region.classes + isObjConf, n * entriesNum + i, 0);
-            float scale = isObjConf ? postprocessRawData(outData[obj_index]) : 1;
+            const T* entry = anchor + i * cellStep;
+            float scale = 1.f;
+            if (hasObjConf) {
+                const float objectness = convert && !isNHWC ? anchorData[i]
+                                                            : static_cast<float>(entry[region.coords * channelStep]);
+                scale = useSigmoid ? sigmoid(objectness) : objectness;
+            }
 
             //--- Preliminary check for confidence threshold conformance
-            if (scale >= confidenceThreshold){
-                //--- Calculating scaled region's coordinates
-                float x, y;
-                if (yoloVersion == YOLOF) {
-                    x = ((float)col / sideW + outData[box_index + 0 * entriesNum] * region.anchors[2 * n] / scaleW) * original_im_w;
-                    y = ((float)row / sideH + outData[box_index + 1 * entriesNum] * region.anchors[2 * n + 1] / scaleH) * original_im_h;
+            if (scale < confidenceThreshold) {
+                continue;
+            }
+
+            //--- f32 view of the entry
+            const float* values = reinterpret_cast<const float*>(entry);
+            int valueStep = channelStep;
+            if (convert) {
+                valueStep = 1;
+                if (isNHWC) {
+                    convertToFloat(entry, entryData.data(), entryData.size());
+                    values = entryData.data();
+                } else if (!hasObjConf) {
+                    values = anchorData.data() + i;
+                    valueStep = entriesNum;
                 } else {
-                    x = (float)(col + postprocessRawData(outData[box_index + 0 * entriesNum])) / sideW * original_im_w;
-                    y = (float)(row + postprocessRawData(outData[box_index + 1 * entriesNum])) / sideH * original_im_h;
-                }
-                float height = (float)std::exp(outData[box_index + 3 * entriesNum]) * region.anchors[2 * n + 1] * original_im_h / scaleH;
-                float width = (float)std::exp(outData[box_index + 2 * entriesNum]) * region.anchors[2 * n] * original_im_w / scaleW;
-
-                DetectedObject obj;
-                obj.x = clamp(x-width/2, 0.f, (float)original_im_w);
-                obj.y = clamp(y-height/2, 0.f, (float)original_im_h);
-                obj.width = clamp(width, 0.f, (float)original_im_w - obj.x);
-                obj.height = clamp(height, 0.f, (float)original_im_h - obj.y);
-
-                for (size_t j = 0; j < region.classes; ++j) {
-                    int class_index = calculateEntryIndex(entriesNum, region.coords, region.classes + isObjConf, n * entriesNum + i, region.coords + isObjConf + j);
-                    float prob = scale * postprocessRawData(outData[class_index]);
-
-                    //--- Checking confidence threshold conformance and adding region to the list
-                    if (prob >= confidenceThreshold) {
-                        obj.confidence = prob;
-                        obj.labelID = j;
-                        obj.label = getLabelName(obj.labelID);
-                        objects.push_back(obj);
+                    // Strided entry of a single cell, there is no run to convert
+                    for (int k = 0; k < entrySize; ++k) {
+                        entryData[k] = static_cast<float>(entry[k * channelStep]);
                     }
+                    values = entryData.data();
+                }
+            }
+
+            //--- Calculating scaled region's coordinates
+            const float rawX = values[0];
+            const float rawY = values[valueStep];
+            float x, y;
+            if (version == YOLOF) {
+                x = (static_cast<float>(col) / sideW + rawX * region.anchors[2 * n] / scaleW) * originalImW;
+                y = (static_cast<float>(row) / sideH + rawY * region.anchors[2 * n + 1] / scaleH) * originalImH;
+            } else {
+                x = (col + (useSigmoid ? sigmoid(rawX) : rawX)) / sideW * originalImW;
+                y = (row + (useSigmoid ? sigmoid(rawY) : rawY)) / sideH * originalImH;
+            }
+            const float height = std::exp(values[3 * valueStep]) * region.anchors[2 * n + 1] * originalImH / scaleH;
+            const float width = std::exp(values[2 * valueStep]) * region.anchors[2 * n] * originalImW / scaleW;
+
+            DetectedObject obj;
+            obj.x = clamp(x - width / 2, 0.f, originalImW);
+            obj.y = clamp(y - height / 2, 0.f, originalImH);
+            obj.width = clamp(width, 0.f, originalImW - obj.x);
+            obj.height = clamp(height, 0.f, originalImH - obj.y);
+
+            const float* classes = values + (region.coords + (hasObjConf ? 1 : 0)) * valueStep;
+            for (size_t j = 0; j < region.classes; ++j) {
+                const float rawProb = classes[j * valueStep];
+                const float prob = scale * (useSigmoid ? sigmoid(rawProb) : rawProb);
+
+                //--- Checking confidence threshold conformance and adding region to the list
+                if (prob >= confidenceThreshold) {
+                    obj.confidence = prob;
+                    obj.labelID = j;
+                    obj.label = getLabelName(obj.labelID);
+                    objects.push_back(obj);
                 }
             }
         }
     }
 }
 
-int ModelYolo::calculateEntryIndex(int totalCells, int lcoords, size_t lclasses, int location, int entry) {
-    int n = location / totalCells;
-    int loc = location % totalCells;
-    return (n * (lcoords + lclasses) + entry) * totalCells + loc;
+template <typename T>
+ModelYolo::RegionDecoder<T> ModelYolo::selectRegionDecoder() const {
+    const bool isNHWC = yoloRegionLayout == ov::Layout("NHWC");
+    switch (yoloVersion) {
+    case YOLO_V1V2:
+        return isNHWC ? &ModelYolo::decodeRegion<T, YOLO_V1V2, true, true>
+                      : &ModelYolo::decodeRegion<T, YOLO_V1V2, true, false>;
+    case YOLO_V3:
+        return isNHWC ? &ModelYolo::decodeRegion<T, YOLO_V3, true, true>
+                      : &ModelYolo::decodeRegion<T, YOLO_V3, true, false>;
+    case YOLO_V4:
+        return isNHWC ? &ModelYolo::decodeRegion<T, YOLO_V4, true, true>
+                      : &ModelYolo::decodeRegion<T, YOLO_V4, true, false>;
+    case YOLO_V4_TINY:
+        return isNHWC ? &ModelYolo::decodeRegion<T, YOLO_V4_TINY, true, true>
+                      : &ModelYolo::decodeRegion<T, YOLO_V4_TINY, true, false>;
+    case YOLOF:
+        return isNHWC ? &ModelYolo::decodeRegion<T, YOLOF, false, true>
+                      : &ModelYolo::decodeRegion<T, YOLOF, false, false>;
+    }
+    throw std::logic_error("Unknown YOLO version");
 }
 
 double ModelYolo::intersectionOverUnion(const DetectedObject& o1, const DetectedObject& o2) {
@@ -124,12 +124,12 @@ void HpeAssociativeEmbedding::changeInputSize(std::shared_ptr<ov::Model>& model)
 std::shared_ptr<InternalModelData> HpeAssociativeEmbedding::preprocess(const InputData& inputData, ov::InferRequest& request) {
     auto& image = inputData.asRef<ImageInputData>().inputImage;
     cv::Rect roi;
-    auto paddedImage = resizeImageExt(image, inputLayerSize.width, inputLayerSize.height, resizeMode, true, &roi);
+    cv::Mat paddedImage = wrapTensor2Mat(request.get_input_tensor());
+    resizeImageExt(image, paddedImage, resizeMode, true, &roi);
     if (inputLayerSize.height - stride >= roi.height
         || inputLayerSize.width - stride >= roi.width) {
         slog::warn << "\tChosen model aspect ratio doesn't match image aspect ratio" << slog::endl;
     }
-    request.set_input_tensor(wrapMat2Tensor(paddedImage));
 
     return std::make_shared<InternalScaleData>(paddedImage.cols, paddedImage.rows,
         image.size().width / static_cast<float>(roi.width), image.size().height / static_cast<float>(roi.height));
@@ -67,6 +67,8 @@ void HPEOpenPose::prepareInputsOutputs(std::shared_ptr<ov::Model>& model) {
         throw std::runtime_error("HPE OpenPose supports topologies with only 2 outputs");
     }
 
+    // Feature maps are upsampled as a whole before decoding, so f16 outputs would be converted in full anyway
+    // and outputsPrecision is ignored
     const ov::Layout outputLayout("NCHW");
     for (const auto& output : model->outputs()) {
         const auto& outTensorName = output.get_any_name();
@@ -128,7 +130,8 @@ void HPEOpenPose::changeInputSize(std::shared_ptr<ov::Model>& model) {
 std::shared_ptr<InternalModelData> HPEOpenPose::preprocess(const InputData& inputData, ov::InferRequest& request) {
     auto& image = inputData.asRef<ImageInputData>().inputImage;
     cv::Rect roi;
-    auto paddedImage = resizeImageExt(image, inputLayerSize.width, inputLayerSize.height, RESIZE_KEEP_ASPECT, true, &roi);
+    cv::Mat paddedImage = wrapTensor2Mat(request.get_input_tensor());
+    resizeImageExt(image, paddedImage, RESIZE_KEEP_ASPECT, true, &roi);
     if (inputLayerSize.width < roi.width)
         throw std::runtime_error("The image aspect ratio doesn't fit current model shape");
 
@@ -136,7 +139,6 @@ std::shared_ptr<InternalModelData> HPEOpenPose::preprocess(const InputData& inpu
         slog::warn << "\tChosen model aspect ratio doesn't match image aspect ratio" << slog::endl;
     }
 
-    request.set_input_tensor(wrapMat2Tensor(paddedImage));
     return std::make_shared<InternalScaleData>(paddedImage.cols, paddedImage.rows,
         image.cols / static_cast<float>(roi.width), image.rows / static_cast<float>(roi.height));
 }
@@ -150,21 +152,10 @@ std::unique_ptr<ResultBase> HPEOpenPose::postprocess(InferenceResult& infResult)
     const ov::Shape& outputShape = outputMapped.get_shape();
     const ov::Shape& heatMapShape = heatMapsMapped.get_shape();
 
-    float* const predictions = outputMapped.data<float>();
-    float* const heats = heatMapsMapped.data<float>();
-
-    std::vector<cv::Mat> heatMaps(keypointsNumber);
-    for (size_t i = 0; i < heatMaps.size(); i++) {
-        heatMaps[i] = cv::Mat(heatMapShape[2], heatMapShape[3], CV_32FC1,
-                              heats + i * heatMapShape[2] * heatMapShape[3]);
-    }
+    std::vector<cv::Mat> heatMaps = wrapFeatureMaps(heatMapsMapped, keypointsNumber);
     resizeFeatureMaps(heatMaps);
 
-    std::vector<cv::Mat> pafs(outputShape[1]);
-    for (size_t i = 0; i < pafs.size(); i++) {
-        pafs[i] = cv::Mat(heatMapShape[2], heatMapShape[3], CV_32FC1,
-                          predictions + i * heatMapShape[2] * heatMapShape[3]);
-    }
+    std::vector<cv::Mat> pafs = wrapFeatureMaps(outputMapped, outputShape[1]);
     resizeFeatureMaps(pafs);
 
     std::vector<HumanPose> poses = extractPoses(heatMaps, pafs);
@@ -187,6 +178,20 @@ std::unique_ptr<ResultBase> HPEOpenPose::postprocess(InferenceResult& infResult)
     return std::unique_ptr<ResultBase>(result);
 }
 
+std::vector<cv::Mat> HPEOpenPose::wrapFeatureMaps(const ov::Tensor& tensor, size_t count) {
+    const ov::Shape& shape = tensor.get_shape();
+    const int height = static_cast<int>(shape[2]);
+    const int width = static_cast<int>(shape[3]);
+    const size_t mapSize = shape[2] * shape[3];
+
+    float* const data = tensor.data<float>();
+    std::vector<cv::Mat> featureMaps(count);
+    for (size_t i = 0; i < count; i++) {
+        featureMaps[i] = cv::Mat(height, width, CV_32FC1, data + i * mapSize);
+    }
+    return featureMaps;
+}
+
 void HPEOpenPose::resizeFeatureMaps(std::vector<cv::Mat>& featureMaps) const {
     for (auto& featureMap : featureMaps) {
         cv::resize(featureMap, featureMap, cv::Size(),
@@ -23,9 +23,36 @@ ImageModel::ImageModel(const std::string& modelFileName, bool useAutoResize, con
     useAutoResize(useAutoResize) {
 }
 
+void ImageModel::addNV12Input(ov::preprocess::PrePostProcessor& ppp, const std::string& inputName) {
+    ppp.input(inputName).tensor().
+        set_element_type(ov::element::u8).
+        set_color_format(ov::preprocess::ColorFormat::NV12_TWO_PLANES, {"y", "uv"}).
+        set_spatial_dynamic_shape();
+    ppp.input(inputName).preprocess().
+        convert_color(ov::preprocess::ColorFormat::BGR).
+        convert_element_type(ov::element::f32).
+        resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR);
+    // Planes become inputs of their own, named after the original input
+    nv12InputsNames = {inputName + "/y", inputName + "/uv"};
+}
+
 std::shared_ptr<InternalModelData> ImageModel::preprocess(const InputData& inputData, ov::InferRequest& request) {
     const auto& origImg = inputData.asRef<ImageInputData>().inputImage;
-    auto img = inputTransform(origImg);
+    auto img = origImg;
+
+    if (nv12Input) {
+        if (nv12InputsNames.empty()) {
+            throw std::logic_error("The model doesn't support NV12 input");
+        }
+        /* Planes are wrapped as they are, without copying, the model converts and resizes them */
+        if (!img.isContinuous()) {
+            img = img.clone();
+        }
+        const cv::Size size = nv12Size(img);
+        request.set_tensor(nv12InputsNames[0], wrapMat2Tensor(img.rowRange(0, size.height)));
+        request.set_tensor(nv12InputsNames[1], wrapMat2Tensor(img.rowRange(size.height, img.rows).reshape(2, size.height / 2)));
+        return std::make_shared<InternalImageModelData>(size.width, size.height);
+    }
 
     if (!useAutoResize) {
         // /* Resize and copy data from the image to the input tensor */
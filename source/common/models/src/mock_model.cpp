@@ -0,0 +1,291 @@
+/*
+// Copyright (C) 2020-2022 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openvino/openvino.hpp>
+#include <utils/common.hpp>
+#include <utils/slog.hpp>
+#include "models/mock_model.h"
+
+namespace {
+struct MockBackend {
+    MockDelay delay;
+    std::vector<ov::Tensor> outputs;  // Canned outputs, in the order of outputs of the op
+};
+
+/// Sleeps for a delay and copies canned outputs. Runs on CPU through the reference implementation
+/// the plugin uses for operations without a native one
+class MockInference : public ov::op::Op {
+public:
+    OPENVINO_OP("MockInference", "demo_extension");
+
+    MockInference() = default;
+    MockInference(const ov::OutputVector& inputs, const std::shared_ptr<const MockBackend>& backend) :
+        Op(inputs), backend(backend) {
+        constructor_validate_and_infer_types();
+    }
+
+    void validate_and_infer_types() override {
+        set_output_size(backend->outputs.size());
+        for (size_t i = 0; i < backend->outputs.size(); ++i) {
+            set_output_type(i, backend->outputs[i].get_element_type(), backend->outputs[i].get_shape());
+        }
+    }
+
+    std::shared_ptr<ov::Node> clone_with_new_inputs(const ov::OutputVector& newArgs) const override {
+        return std::make_shared<MockInference>(newArgs, backend);
+    }
+
+    bool visit_attributes(ov::AttributeVisitor&) override { return true; }
+
+    bool has_evaluate() const override { return true; }
+
+    bool evaluate(ov::TensorVector& outputs, const ov::TensorVector&) const override {
+        std::this_thread::sleep_for(backend->delay.sample());
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            const ov::Tensor& canned = backend->outputs[i];
+            if (outputs[i].get_byte_size() != canned.get_byte_size()) {
+                return false;
+            }
+            std::memcpy(outputs[i].data(), canned.data(), canned.get_byte_size());
+        }
+        return true;
+    }
+
+private:
+    std::shared_ptr<const MockBackend> backend;
+};
+
+// Element types of saved outputs, by name
+const std::vector<ov::element::Type>& savedTypes() {
+    static const std::vector<ov::element::Type> types = {
+        ov::element::f32, ov::element::f16, ov::element::i32, ov::element::i64, ov::element::u8};
+    return types;
+}
+
+template <typename T>
+void writeValue(std::ofstream& file, T value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T readValue(std::ifstream& file) {
+    T value;
+    if (!file.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+        throw std::runtime_error("Outputs file is truncated");
+    }
+    return value;
+}
+
+void writeString(std::ofstream& file, const std::string& str) {
+    writeValue<uint32_t>(file, static_cast<uint32_t>(str.size()));
+    file.write(str.data(), str.size());
+}
+
+std::string readString(std::ifstream& file) {
+    std::string str(readValue<uint32_t>(file), '\0');
+    if (!file.read(&str[0], str.size())) {
+        throw std::runtime_error("Outputs file is truncated");
+    }
+    return str;
+}
+}  // namespace
+
+ModelWrapper::ModelWrapper(std::unique_ptr<ModelBase>&& model) :
+    ModelBase(model->getModelFileName()), wrapped(std::move(model)) {}
+
+ov::CompiledModel ModelWrapper::compileModel(const ModelConfig& config, ov::Core& core) {
+    compiledModel = wrapped->compileModel(config, core);
+    copyNames();
+    return compiledModel;
+}
+
+void ModelWrapper::copyNames() {
+    inputsNames = wrapped->getInputsNames();
+    outputsNames = wrapped->getOutputsNames();
+}
+
+MockDelay::MockDelay(const std::string& spec) : distribution(Distribution::Fixed), a(0.0), b(0.0) {
+    const auto& fields = split(spec, ':');
+    try {
+        if (fields.size() == 1) {
+            a = std::stod(fields[0]);
+        } else if (fields[0] == "uniform" && fields.size() == 3) {
+            distribution = Distribution::Uniform;
+            a = std::stod(fields[1]);
+            b = std::stod(fields[2]);
+        } else if (fields[0] == "normal" && fields.size() == 3) {
+            distribution = Distribution::Normal;
+            a = std::stod(fields[1]);
+            b = std::stod(fields[2]);
+        } else if (fields[0] == "exponential" && fields.size() == 2) {
+            distribution = Distribution::Exponential;
+            a = std::stod(fields[1]);
+        } else {
+            throw std::invalid_argument(spec);
+        }
+    } catch (const std::logic_error&) {
+        throw std::runtime_error("Invalid mock delay \"" + spec +
+            "\", expected <ms>, uniform:<min>:<max>, normal:<mean>:<stddev> or exponential:<mean>");
+    }
+    if (a < 0.0 || b < 0.0 || (distribution == Distribution::Uniform && b < a)) {
+        throw std::runtime_error("Invalid mock delay \"" + spec + "\", delays should be non-negative");
+    }
+}
+
+std::chrono::duration<double, std::milli> MockDelay::sample() const {
+    thread_local std::mt19937 generator{std::random_device{}()};
+    double ms = a;
+    switch (distribution) {
+    case Distribution::Fixed:
+        break;
+    case Distribution::Uniform:
+        ms = std::uniform_real_distribution<double>(a, b)(generator);
+        break;
+    case Distribution::Normal:
+        ms = std::normal_distribution<double>(a, b)(generator);
+        break;
+    case Distribution::Exponential:
+        ms = a > 0.0 ? std::exponential_distribution<double>(1.0 / a)(generator) : 0.0;
+        break;
+    }
+    return std::chrono::duration<double, std::milli>(std::max(0.0, ms));
+}
+
+MockModel::MockModel(std::unique_ptr<ModelBase>&& model, const std::string& delay, const std::string& outputsFileName) :
+    ModelWrapper(std::move(model)), delay(delay), outputsFileName(outputsFileName) {}
+
+ov::CompiledModel MockModel::compileModel(const ModelConfig& config, ov::Core& core) {
+    std::shared_ptr<ov::Model> model = wrapped->readModel(config, core);
+    copyNames();
+
+    std::map<std::string, ov::Tensor> saved;
+    if (!outputsFileName.empty()) {
+        saved = loadOutputs(outputsFileName);
+    }
+    auto backend = std::make_shared<MockBackend>(MockBackend{delay, {}});
+    for (const auto& output : model->outputs()) {
+        if (output.get_partial_shape().is_dynamic()) {
+            throw std::runtime_error("Mock inference needs static shapes of outputs, output " + output.get_any_name() + " is dynamic");
+        }
+        ov::Tensor canned(output.get_element_type(), output.get_shape());
+        auto it = saved.find(output.get_any_name());
+        if (it != saved.end()) {
+            if (it->second.get_element_type() != canned.get_element_type() || it->second.get_shape() != canned.get_shape()) {
+                throw std::runtime_error("Canned output " + it->first + " doesn't match the model, it is " +
+                    it->second.get_element_type().get_type_name() + " " + it->second.get_shape().to_string());
+            }
+            canned = it->second;
+        } else {
+            if (!saved.empty()) {
+                slog::warn << "No canned output " << output.get_any_name() << " in " << outputsFileName << ", zeros are returned" << slog::endl;
+            }
+            std::memset(canned.data(), 0, canned.get_byte_size());
+        }
+        backend->outputs.push_back(canned);
+    }
+
+    //--- Same inputs, so tensors set by preprocessing of the wrapped model fit
+    ov::ParameterVector parameters;
+    ov::OutputVector inputs;
+    for (const auto& parameter : model->get_parameters()) {
+        auto mockParameter = std::make_shared<ov::op::v0::Parameter>(parameter->get_element_type(), parameter->get_partial_shape());
+        mockParameter->set_friendly_name(parameter->get_friendly_name());
+        mockParameter->set_layout(parameter->get_layout());
+        mockParameter->output(0).get_tensor().set_names(parameter->output(0).get_names());
+        parameters.push_back(mockParameter);
+        inputs.push_back(mockParameter->output(0));
+    }
+    auto mock = std::make_shared<MockInference>(inputs, backend);
+    ov::ResultVector results;
+    for (size_t i = 0; i < model->outputs().size(); ++i) {
+        mock->output(i).get_tensor().set_names(model->output(i).get_names());
+        results.push_back(std::make_shared<ov::op::v0::Result>(mock->output(i)));
+    }
+
+    slog::info << "Inference of " << modelFileName << " is mocked, outputs are " <<
+        (outputsFileName.empty() ? "zeros" : "read from " + outputsFileName) << slog::endl;
+    compiledModel = core.compile_model(std::make_shared<ov::Model>(results, parameters, "mock"), "CPU", config.compiledModelConfig);
+    return compiledModel;
+}
+
+// Layout: uint32 number of outputs, then for every output: name, element type name, uint32 rank,
+// uint64 dimensions, raw data. Strings are uint32 length followed by characters
+void MockModel::saveOutputs(const std::map<std::string, ov::Tensor>& outputs, const std::string& fileName) {
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Can't open outputs file " + fileName);
+    }
+    writeValue<uint32_t>(file, static_cast<uint32_t>(outputs.size()));
+    for (const auto& output : outputs) {
+        const ov::Tensor& tensor = output.second;
+        writeString(file, output.first);
+        writeString(file, tensor.get_element_type().get_type_name());
+        writeValue<uint32_t>(file, static_cast<uint32_t>(tensor.get_shape().size()));
+        for (size_t dim : tensor.get_shape()) {
+            writeValue<uint64_t>(file, dim);
+        }
+        file.write(static_cast<const char*>(tensor.data()), tensor.get_byte_size());
+    }
+}
+
+std::map<std::string, ov::Tensor> MockModel::loadOutputs(const std::string& fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Can't open outputs file " + fileName);
+    }
+    std::map<std::string, ov::Tensor> outputs;
+    for (uint32_t outputsNum = readValue<uint32_t>(file); outputsNum > 0; --outputsNum) {
+        const std::string name = readString(file);
+        const std::string typeName = readString(file);
+        const auto& types = savedTypes();
+        auto type = std::find_if(types.begin(), types.end(),
+            [&typeName](const ov::element::Type& type) { return type.get_type_name() == typeName; });
+        if (type == types.end()) {
+            throw std::runtime_error("Unsupported element type " + typeName + " of output " + name);
+        }
+        ov::Shape shape(readValue<uint32_t>(file));
+        for (auto& dim : shape) {
+            dim = static_cast<size_t>(readValue<uint64_t>(file));
+        }
+        ov::Tensor tensor(*type, shape);
+        if (!file.read(static_cast<char*>(tensor.data()), tensor.get_byte_size())) {
+            throw std::runtime_error("Outputs file " + fileName + " is truncated");
+        }
+        outputs.emplace(name, tensor);
+    }
+    return outputs;
+}
+
+OutputsRecorder::OutputsRecorder(std::unique_ptr<ModelBase>&& model, const std::string& outputsFileName) :
+    ModelWrapper(std::move(model)), outputsFileName(outputsFileName) {}
+
+std::unique_ptr<ResultBase> OutputsRecorder::postprocess(InferenceResult& infResult) {
+    //--- Results are postprocessed by one thread
+    if (!recorded) {
+        recorded = true;
+        MockModel::saveOutputs(infResult.outputsData, outputsFileName);
+        slog::info << "Outputs of frame " << infResult.frameId << " are written to " << outputsFileName << slog::endl;
+    }
+    return wrapped->postprocess(infResult);
+}
@@ -14,6 +14,7 @@
 // limitations under the License.
 */
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -23,6 +24,37 @@
 #include "models/segmentation_model.h"
 #include "models/results.h"
 
+static inline const float* toFloatRow(const float* src, float*, size_t) {
+    return src;
+}
+
+static inline const float* toFloatRow(const ov::float16* src, float* buffer, size_t count) {
+    convertToFloat(src, buffer, count);
+    return buffer;
+}
+
+// Walks the output channel by channel, so f16 rows are converted once with SIMD routines
+template <typename T>
+static void argMaxChannels(const T* data, int channels, int height, int width, cv::Mat& classes) {
+    std::vector<float> rowBuffer(width);
+    std::vector<float> maxProbs(width);
+    for (int rowId = 0; rowId < height; ++rowId) {
+        uint8_t* classRow = classes.ptr<uint8_t>(rowId);
+        std::fill(classRow, classRow + width, 0);
+        std::fill(maxProbs.begin(), maxProbs.end(), -1.0f);
+        for (int chId = 0; chId < channels; ++chId) {
+            const float* probs = toFloatRow(data + (static_cast<size_t>(chId) * height + rowId) * width,
+                rowBuffer.data(), width);
+            for (int colId = 0; colId < width; ++colId) {
+                if (probs[colId] > maxProbs[colId]) {
+                    classRow[colId] = static_cast<uint8_t>(chId);
+                    maxProbs[colId] = probs[colId];
+                }
+            } // width
+        } // nChannels
+    } // height
+}
+
 SegmentationModel::SegmentationModel(const std::string& modelFileName, bool useAutoResize, const std::string& layout) :
     ImageModel(modelFileName, useAutoResize, layout) {}
 
@@ -74,12 +106,17 @@ void SegmentationModel::prepareInputsOutputs(std::shared_ptr<ov::Model>& model)
             resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR);
     }
 
+    inputTransform.setPreprocessing(ppp, input.get_any_name());
+
     ppp.input().model().set_layout(inputLayout);
-    model = ppp.build();
     // --------------------------- Prepare output  -----------------------------------------------------
     if (model->outputs().size() != 1) {
         throw std::logic_error("Segmentation model wrapper supports topologies with only 1 output");
     }
+    if (model->output().get_element_type().is_real()) {
+        ppp.output().tensor().set_element_type(outputsPrecision);
+    }
+    model = ppp.build();
 
     const auto& output = model->output();
     outputsNames.push_back(output.get_any_name());
@@ -124,22 +161,10 @@ std::unique_ptr<ResultBase> SegmentationModel::postprocess(InferenceResult& infR
         predictions.convertTo(result->resultImage, CV_8UC1);
     }
     else if (outTensor.get_element_type() == ov::element::f32) {
-        const float* data = outTensor.data<float>();
-        for (int rowId = 0; rowId < outHeight; ++rowId) {
-            for (int colId = 0; colId < outWidth; ++colId) {
-                int classId = 0;
-                float maxProb = -1.0f;
-                for (int chId = 0; chId < outChannels; ++chId) {
-                    float prob = data[chId * outHeight * outWidth + rowId * outWidth + colId];
-                    if (prob > maxProb) {
-                        classId = chId;
-                        maxProb = prob;
-                    }
-                } // nChannels
-
-                result->resultImage.at<uint8_t>(rowId, colId) = classId;
-            } // width
-        } // height
+        argMaxChannels(outTensor.data<float>(), outChannels, outHeight, outWidth, result->resultImage);
+    }
+    else if (outTensor.get_element_type() == ov::element::f16) {
+        argMaxChannels(outTensor.data<ov::float16>(), outChannels, outHeight, outWidth, result->resultImage);
     }
 
     cv::resize(result->resultImage, result->resultImage,
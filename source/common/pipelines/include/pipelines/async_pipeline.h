@@ -52,6 +52,10 @@ public:
     /// and next frame can be submitted for processing, false otherwise.
     bool isReadyToProcess() { return requestsPool->isIdleRequestAvailable(); }
 
+    /// @returns number of frames which can be submitted for processing right now.
+    /// Lets a caller submit a batch of frames as a burst without waiting between them.
+    size_t getIdleRequestsCount() { return requestsPool->getIdleRequestsCount(); }
+
     /// Waits for all currently submitted requests to be completed.
     ///
     void waitForTotalCompletion() { if (requestsPool) requestsPool->waitForTotalCompletion(); }
@@ -80,6 +84,14 @@ protected:
     /// @returns InferenceResult with processed information or empty InferenceResult (with negative frameID) if there's no any results yet.
     virtual InferenceResult getInferenceResult(bool shouldKeepOrder);
 
+    /// Called right before an infer request is started, e.g. to trace requests.
+    /// @param metaData - metadata of the submitted data, might be null
+    virtual void onRequestStarted(const std::shared_ptr<MetaData>& metaData) {}
+
+    /// Called from the completion callback of an infer request, on a thread of the inference runtime.
+    /// @param metaData - metadata of the submitted data, might be null
+    virtual void onRequestCompleted(const std::shared_ptr<MetaData>& metaData) {}
+
     std::unique_ptr<RequestsPool> requestsPool;
     std::unordered_map<int64_t, InferenceResult> completedInferenceResults;
 
@@ -32,6 +32,8 @@ struct MetaData {
 struct ImageMetaData : public MetaData {
     cv::Mat img;
     std::chrono::steady_clock::time_point timeStamp;
+    double sourceScale = 1.0;  ///< size of the source over the size of img, if img was decoded reduced
+    bool nv12 = false;  ///< img holds NV12 planes, see nv12Size() of utils/image_utils.h
 
     ImageMetaData() {
     }
@@ -47,6 +47,10 @@ public:
     /// @returns number of requests in use
     bool isIdleRequestAvailable();
 
+    /// Returns number of idle requests. This function is thread safe.
+    /// @returns number of idle requests
+    size_t getIdleRequestsCount();
+
     /// Waits for completion of every non-idle requests in pool.
     /// getIdleRequest should not be called together with this function or after it to avoid race condition or invalid state
     /// @returns number of requests in use
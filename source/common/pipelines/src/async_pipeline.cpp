@@ -96,6 +96,7 @@ int64_t AsyncPipeline::submitData(const InputData& inputData, const std::shared_
 
     request.set_callback(
         [this, request, frameID, internalModelData, metaData, startTime](std::exception_ptr ex) mutable {
+            onRequestCompleted(metaData);
             {
                 const std::lock_guard<std::mutex> lock(mtx);
                 inferenceMetrics.update(startTime);
@@ -130,6 +131,7 @@ int64_t AsyncPipeline::submitData(const InputData& inputData, const std::shared_
     if (inputFrameId < 0)
         inputFrameId = 0;
 
+    onRequestStarted(metaData);
     request.start_async();
 
     return frameID;
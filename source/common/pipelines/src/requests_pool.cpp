@@ -65,6 +65,11 @@ bool RequestsPool::isIdleRequestAvailable() {
     return numRequestsInUse < requests.size();
 }
 
+size_t RequestsPool::getIdleRequestsCount() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return requests.size() - numRequestsInUse;
+}
+
 void RequestsPool::waitForTotalCompletion() {
     // Do not synchronize here to avoid deadlock (despite synchronization in other functions)
     // Request status will be changed to idle in callback,
@@ -0,0 +1,50 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+/**
+ * @brief a header file for the pool of reusable frame buffers
+ * @file frame_buffer_pool.hpp
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+/// Bounded pool of frame buffers for readers that have to return frames they own.
+/// A pooled buffer is free again once the pool holds the only reference to it, so it is returned
+/// by whatever drops the last cv::Mat sharing it: a caller, a ROI view or a pipeline blob deleter.
+class FrameBufferPool {
+public:
+    struct Stats {
+        uint64_t requests;
+        uint64_t hits;  ///< requests served by a free buffer of the same size and type
+        size_t buffers;  ///< buffers allocated by the pool
+        size_t highWaterMark;  ///< maximum number of pooled buffers referenced outside of the pool at once
+
+        double hitRate() const { return requests ? static_cast<double>(hits) / requests : 0.0; }
+    };
+
+    explicit FrameBufferPool(size_t capacity);
+
+    /// Returns a buffer of the given size and type with undefined content.
+    /// Allocates an unpooled buffer if every pooled one is in use and the pool is full.
+    cv::Mat acquire(cv::Size size, int type);
+    /// Returns a pooled copy of src
+    cv::Mat copy(const cv::Mat& src);
+
+    size_t capacity() const { return maxBuffers; }
+    Stats getStats() const;
+
+private:
+    const size_t maxBuffers;
+    mutable std::mutex mtx;
+    std::vector<cv::Mat> buffers;
+    uint64_t requests;
+    uint64_t hits;
+    size_t highWaterMark;
+};
@@ -25,3 +25,37 @@ enum RESIZE_MODE {
 };
 
 cv::Mat resizeImageExt(const cv::Mat& mat, int width, int height, RESIZE_MODE resizeMode = RESIZE_FILL, bool hqResize = false, cv::Rect* roi = nullptr);
+
+/// Resizes image straight into a preallocated destination (e.g. a view over request tensor memory) in a single pass.
+/// Destination size defines the target size. In letterbox and keep-aspect modes only the border strips are filled.
+/// @param mat - source image
+/// @param dst - preallocated destination of the same type as mat
+/// @param resizeMode - resize mode
+/// @param hqResize - interpolation selector, same as for the allocating overload
+/// @param roi - optional. Receives the area of dst occupied by the resized image
+/// @param scale - optional. Receives the horizontal and vertical scale factors applied to the source image
+void resizeImageExt(const cv::Mat& mat, cv::Mat& dst, RESIZE_MODE resizeMode = RESIZE_FILL, bool hqResize = false,
+    cv::Rect* roi = nullptr, cv::Point2f* scale = nullptr);
+
+/// NV12 frames are single channel images of height * 3 / 2 rows: the Y plane followed by the plane of interleaved U and V,
+/// subsampled by 2 in both directions
+inline cv::Size nv12Size(const cv::Mat& nv12) {
+    return cv::Size(nv12.cols, nv12.rows * 2 / 3);
+}
+
+/// Converts a BGR image to an NV12 frame. The last row or column of an odd sized image is dropped
+cv::Mat bgrToNV12(const cv::Mat& bgr);
+
+/// Converts a BGR image to an NV12 frame in nv12, which is reallocated only if it isn't of the size and type
+/// of the result, so a pooled buffer from FrameBufferPool::acquire(bgrToNV12Size(bgr), CV_8UC1) is written in place
+void bgrToNV12(const cv::Mat& bgr, cv::Mat& nv12);
+
+/// Size of the NV12 frame bgrToNV12() makes of the image
+inline cv::Size bgrToNV12Size(const cv::Mat& bgr) {
+    return cv::Size(bgr.cols & ~1, (bgr.rows & ~1) * 3 / 2);
+}
+
+/// Converts the roi of an NV12 frame to BGR, the whole frame if the roi is empty.
+/// The roi is widened to even coordinates, as chroma covers 2x2 pixels
+/// @param alignedRoi - optional. Receives the widened roi
+cv::Mat nv12ToBGR(const cv::Mat& nv12, cv::Rect roi = cv::Rect(), cv::Rect* alignedRoi = nullptr);
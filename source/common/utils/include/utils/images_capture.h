@@ -2,28 +2,60 @@
 // SPDX-License-Identifier: Apache-2.0
 //
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <opencv2/core/mat.hpp>
 #include <opencv2/videoio.hpp>
+#include "utils/frame_buffer_pool.hpp"
 #include "utils/performance_metrics.hpp"
 
-enum class read_type {efficient, safe};
+// efficient may return frames sharing the reader's memory, safe returns copies,
+// prefetch decodes ahead of read() on separate threads: videos on one thread, image folders on a pool of threads.
+// Other inputs read safe
+enum class read_type {efficient, safe, prefetch};
+
+// Waits between a reader decoding ahead and its consumer
+struct PrefetchStats {
+    uint64_t frames;
+    double decodeMs;  ///< average decoding time of a frame
+    uint64_t consumerStalls;  ///< reads that waited for decoding, decoding is the bottleneck
+    double consumerStallMs;
+    uint64_t decoderStalls;  ///< decoder waits for room ahead, the consumer is the bottleneck
+    double decoderStallMs;
+};
 
 class ImagesCapture {
 public:
     const bool loop;
 
-    ImagesCapture(bool loop) : loop{loop} {}
+    ImagesCapture(bool loop) : loop{loop}, framePool{std::make_shared<FrameBufferPool>(4)}, sourceScale{1.0} {}
     virtual double fps() const = 0;
     virtual cv::Mat read() = 0;
     virtual std::string getType() const = 0;
     const PerformanceMetrics& getMetrics() { return readerMetrics; }
+    // Frames that must not share the reader's memory are copied into buffers of this pool.
+    // The pool can be shared by consecutive captures of the same input, e.g. when it is reopened to loop
+    virtual void setFramePool(const std::shared_ptr<FrameBufferPool>& pool) { framePool = pool; }
+    const std::shared_ptr<FrameBufferPool>& getFramePool() const { return framePool; }
+    // Returns false if the capture doesn't decode ahead
+    virtual bool getPrefetchStats(PrefetchStats& stats) const { return false; }
+    // Size of the input over the size of returned frames, greater than 1 if frames are decoded reduced.
+    // Coordinates on a frame times the scale are coordinates on the input
+    double getSourceScale() const { return sourceScale; }
     virtual ~ImagesCapture() = default;
 
 protected:
     PerformanceMetrics readerMetrics;
+    std::shared_ptr<FrameBufferPool> framePool;
+    double sourceScale;
 };
 
 // An advanced version of
@@ -36,7 +68,108 @@ protected:
 // }
 // Some VideoCapture backends continue owning the video buffer under cv::Mat. safe_copy forses to return a copy from read()
 // https://github.com/opencv/opencv/blob/46e1560678dba83d25d309d8fbce01c40f21b7be/modules/gapi/include/opencv2/gapi/streaming/cap.hpp#L72-L76
+// synthetic:<width>x<height>[@<fps>][:<pattern>[:<frames>]] generates frames instead, see SyntheticCapture
+// With nv12 videos return frames as decoded, without the conversion to BGR, if the backend can, e.g. a GStreamer pipeline
+// ending with "video/x-raw,format=NV12 ! appsink". Frames of other backends, e.g. the default FFmpeg one, and other inputs
+// are converted to NV12 on the CPU. A backend returning frames that are neither BGR nor NV12 fails read()
 std::unique_ptr<ImagesCapture> openImagesCapture(const std::string &input,
     bool loop, read_type type=read_type::efficient, size_t initialImageId=0,
     size_t readLengthLimit=std::numeric_limits<size_t>::max(),  // General option
-    cv::Size cameraResolution={1280, 720});
+    cv::Size cameraResolution={1280, 720},
+    size_t prefetchDepth=4,  // Frames decoded ahead with read_type::prefetch
+    size_t decodeThreads=0,  // Threads decoding images of a folder with read_type::prefetch, 0 is up to one per core
+    cv::Size decodeSize={},  // Smallest frame size needed, e.g. the network input. See reducedDecodeScale
+    bool nv12=false);  // Return NV12 frames, see nv12Size() of utils/image_utils.h
+
+// Frames of a video read by openImagesCapture() with initialImageId=firstFrame and readLengthLimit=frameNum
+struct VideoSegment {
+    size_t firstFrame;
+    size_t frameNum;  ///< the last segment lasts to the end, std::numeric_limits<size_t>::max()
+};
+
+// Splits a video file into up to n segments of about equal length, to be decoded in parallel by captures of their own.
+// Segments begin at keyframes, so seeking to a segment decodes no frames of the previous one. Keyframes are found by reading
+// packets without decoding (OpenCV 4.6 and later with FFmpeg) and placed in presentation order by their PTS. Without
+// keyframe information or distinct PTS segments are split evenly by the frame count
+std::vector<VideoSegment> splitVideo(const std::string &input, size_t n);
+
+// Largest of 2, 4 and 8 the source size can be divided by keeping at least the target size, 1 if none or the target is empty.
+// Images are decoded reduced in the DCT domain where the format allows it (cv::IMREAD_REDUCED_COLOR_<scale>).
+// JPEG and PNG sizes are read from the file header, so nothing is decoded twice. Videos have no reduced decoding and
+// are read at full size, the model resizes them anyway; a GStreamer pipeline can scale them in the backend instead,
+// e.g. "... ! videoscale ! video/x-raw,width=640,height=360 ! appsink".
+// A folder is scaled as its first image, as if all images were of one size
+int reducedDecodeScale(cv::Size source, cv::Size target);
+
+// Decodes frames of the wrapped capture on its own thread, up to depth frames ahead of read(), so decoding
+// overlaps with whatever the caller does between reads. The wrapped capture must return frames it doesn't
+// own (read_type::safe), they are pooled copies. Looping and length limits are the wrapped capture's.
+class ReadAheadCapture : public ImagesCapture {
+public:
+    ReadAheadCapture(std::unique_ptr<ImagesCapture>&& capture, size_t depth);
+    ~ReadAheadCapture() override;
+
+    double fps() const override { return capFps; }
+    cv::Mat read() override;
+    std::string getType() const override { return capType; }
+    void setFramePool(const std::shared_ptr<FrameBufferPool>& pool) override;
+    bool getPrefetchStats(PrefetchStats& stats) const override;
+
+private:
+    void decode();
+
+    std::unique_ptr<ImagesCapture> capture;
+    const size_t depth;
+    const double capFps;
+    const std::string capType;
+
+    std::mutex captureMtx;  // Held while the wrapped capture decodes
+    mutable std::mutex mtx;
+    std::condition_variable frameReady;
+    std::condition_variable roomReady;
+    std::deque<cv::Mat> frames;  // Empty frame is the end of the input
+    std::exception_ptr error;
+    bool stop;
+    PrefetchStats stats;
+    std::thread decoder;
+};
+
+// Keeps frames of the first pass over the input in memory and serves later loops from there, without decoding.
+// Cached frames are returned as they are, shared by every loop, so callers must not write to them.
+// If the input doesn't fit into memoryLimit bytes, the cache is dropped and the input is read again on every loop
+class CachedCapture : public ImagesCapture {
+public:
+    struct Stats {
+        size_t frames;  ///< cached frames
+        size_t bytes;  ///< memory taken by cached frames
+        bool complete;  ///< the whole input is cached, later loops decode nothing
+        bool streaming;  ///< the input didn't fit, every loop decodes it
+        uint64_t loops;  ///< passes over the input after the first one
+    };
+
+    // opener opens the input without looping, it is called again for every loop when streaming
+    CachedCapture(std::function<std::unique_ptr<ImagesCapture>()> opener, bool loop, size_t memoryLimit);
+
+    double fps() const override { return capFps; }
+    cv::Mat read() override;
+    std::string getType() const override { return capType; }
+
+    Stats getStats() const;
+
+private:
+    std::function<std::unique_ptr<ImagesCapture>()> opener;
+    std::unique_ptr<ImagesCapture> capture;  // Reset once the input is cached
+    const size_t memoryLimit;
+    const double capFps;
+    const std::string capType;
+    std::vector<cv::Mat> frames;
+    size_t bytes;
+    size_t nextFrame;
+    bool complete;
+    bool streaming;
+    uint64_t loops;
+};
+
+// Opens the input for CachedCapture, the arguments are as of openImagesCapture
+std::unique_ptr<ImagesCapture> openCachedCapture(const std::string &input, bool loop, size_t memoryLimit,
+    size_t initialImageId=0, size_t readLengthLimit=std::numeric_limits<size_t>::max(), cv::Size decodeSize={}, bool nv12=false);
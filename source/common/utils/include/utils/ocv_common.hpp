@@ -100,6 +100,43 @@ static UNUSED ov::Tensor wrapMat2Tensor(const cv::Mat& mat) {
     return ov::Tensor(precision, ov::Shape{ 1, height, width, channels }, ov::Allocator(allocator));
 }
 
+/**
+* @brief Wraps memory of a dense NHWC tensor with batch 1 as cv::Mat without copying.
+* @param tensor - u8 or f32 tensor to wrap. It must outlive the returned cv::Mat.
+*/
+static UNUSED cv::Mat wrapTensor2Mat(const ov::Tensor& tensor) {
+    static const ov::Layout layout{"NHWC"};
+    const ov::Shape& shape = tensor.get_shape();
+    if (shape.size() != 4 || shape[ov::layout::batch_idx(layout)] != 1) {
+        throw std::runtime_error("Only 4D tensors with batch 1 can be wrapped");
+    }
+    const auto& precision = tensor.get_element_type();
+    if (precision != ov::element::u8 && precision != ov::element::f32) {
+        throw std::runtime_error("Unsupported tensor precision for wrapping");
+    }
+    const int channels = static_cast<int>(shape[ov::layout::channels_idx(layout)]);
+    const int type = precision == ov::element::u8 ? CV_MAKETYPE(CV_8U, channels) : CV_MAKETYPE(CV_32F, channels);
+    return cv::Mat(static_cast<int>(shape[ov::layout::height_idx(layout)]),
+                   static_cast<int>(shape[ov::layout::width_idx(layout)]), type, tensor.data());
+}
+
+/**
+* @brief Converts a contiguous run of output tensor elements to f32.
+* f16 data is converted by OpenCV SIMD routines, so only the elements actually read are converted.
+* @param src - source elements
+* @param dst - destination buffer for at least count elements
+* @param count - number of elements to convert
+*/
+static inline void convertToFloat(const float* src, float* dst, size_t count) {
+    std::copy(src, src + count, dst);
+}
+
+static inline void convertToFloat(const ov::float16* src, float* dst, size_t count) {
+    const cv::Mat srcMat(1, static_cast<int>(count), CV_16FC1, const_cast<ov::float16*>(src));
+    cv::Mat dstMat(1, static_cast<int>(count), CV_32FC1, dst);
+    srcMat.convertTo(dstMat, CV_32F);
+}
+
 static inline void resize2tensor(const cv::Mat& mat, const ov::Tensor& tensor) {
     static const ov::Layout layout{"NHWC"};
     const ov::Shape& shape = tensor.get_shape();
@@ -227,23 +264,25 @@ public:
         return cv::Scalar(values[0], values[1], values[2]);
     }
 
-    void setPrecision(ov::preprocess::PrePostProcessor& ppp, const std::string& tensorName) {
-        const auto precision = isTrivial ? ov::element::u8 : ov::element::f32;
-        ppp.input(tensorName).tensor().
-                set_element_type(precision);
-    }
-
-    cv::Mat operator()(const cv::Mat& inputs) {
-        if (isTrivial) { return inputs; }
-        cv::Mat result;
-        inputs.convertTo(result, CV_32F);
+    /// Appends mean/scale normalization and channel reversal to the input preprocessing graph,
+    /// so the input tensor stays u8 and no per-frame conversion is done on the CPU.
+    /// Must be called after the input tensor layout is set and after any resize step.
+    void setPreprocessing(ov::preprocess::PrePostProcessor& ppp, const std::string& tensorName) {
+        if (isTrivial) { return; }
+        auto& steps = ppp.input(tensorName).preprocess();
+        steps.convert_element_type(ov::element::f32);
         if (reverseInputChannels) {
-            cv::cvtColor(result, result, cv::COLOR_BGR2RGB);
+            steps.reverse_channels();
         }
-        return (result - means) / stdScales;
+        steps.mean(scalar2Vec(means)).
+              scale(scalar2Vec(stdScales));
     }
 
 private:
+    static std::vector<float> scalar2Vec(const cv::Scalar& scalar) {
+        return { static_cast<float>(scalar[0]), static_cast<float>(scalar[1]), static_cast<float>(scalar[2]) };
+    }
+
     bool reverseInputChannels;
     bool isTrivial;
     cv::Scalar means;
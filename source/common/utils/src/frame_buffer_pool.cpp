@@ -0,0 +1,69 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "utils/frame_buffer_pool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+bool isFree(const cv::Mat& buffer) {
+    // Pool holds one reference, others belong to returned frames and their views
+    return CV_XADD(&buffer.u->refcount, 0) == 1;
+}
+}  // namespace
+
+FrameBufferPool::FrameBufferPool(size_t capacity)
+    : maxBuffers(capacity), requests(0), hits(0), highWaterMark(0) {
+    if (0 == capacity) {
+        throw std::invalid_argument("Frame buffer pool capacity must be positive");
+    }
+    buffers.reserve(capacity);
+}
+
+cv::Mat FrameBufferPool::acquire(cv::Size size, int type) {
+    std::lock_guard<std::mutex> lock(mtx);
+    ++requests;
+
+    cv::Mat* reusable = nullptr;  // free buffer of another size or type
+    cv::Mat* found = nullptr;
+    size_t inUse = 0;
+    for (auto& buffer : buffers) {
+        if (!isFree(buffer)) {
+            ++inUse;
+        } else if (!found && buffer.size() == size && buffer.type() == type) {
+            found = &buffer;
+        } else if (!reusable) {
+            reusable = &buffer;
+        }
+    }
+
+    if (found) {
+        ++hits;
+    } else if (reusable) {
+        reusable->create(size, type);  // the pool holds the only reference, so the old buffer is released
+        found = reusable;
+    } else if (buffers.size() < maxBuffers) {
+        buffers.emplace_back(size, type);
+        found = &buffers.back();
+    } else {
+        return cv::Mat(size, type);
+    }
+    highWaterMark = std::max(highWaterMark, inUse + 1);
+    return *found;
+}
+
+cv::Mat FrameBufferPool::copy(const cv::Mat& src) {
+    if (src.empty()) {
+        return cv::Mat{};
+    }
+    cv::Mat dst = acquire(src.size(), src.type());
+    src.copyTo(dst);
+    return dst;
+}
+
+FrameBufferPool::Stats FrameBufferPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return {requests, hits, buffers.size(), highWaterMark};
+}
@@ -16,6 +16,8 @@
 
 #include "utils/image_utils.h"
 
+#include <stdexcept>
+
 cv::Mat resizeImageExt(const cv::Mat& mat, int width, int height, RESIZE_MODE resizeMode, bool hqResize, cv::Rect* roi) {
     if (width == mat.cols && height == mat.rows) {
         return mat;
@@ -53,3 +55,102 @@ cv::Mat resizeImageExt(const cv::Mat& mat, int width, int height, RESIZE_MODE re
     }
     return dst;
 }
+
+void resizeImageExt(const cv::Mat& mat, cv::Mat& dst, RESIZE_MODE resizeMode, bool hqResize, cv::Rect* roi, cv::Point2f* scale) {
+    if (dst.empty() || dst.type() != mat.type()) {
+        throw std::invalid_argument("resizeImageExt: destination must be preallocated with the source image type");
+    }
+
+    const int width = dst.cols;
+    const int height = dst.rows;
+    int interpMode = hqResize ? cv::INTER_LINEAR : cv::INTER_CUBIC;
+
+    cv::Rect area(0, 0, width, height);
+    if (resizeMode != RESIZE_FILL) {
+        double s = std::min(static_cast<double>(width) / mat.cols, static_cast<double>(height) / mat.rows);
+        int resizedWidth = std::min(width, cvRound(mat.cols * s));
+        int resizedHeight = std::min(height, cvRound(mat.rows * s));
+
+        int dx = resizeMode == RESIZE_KEEP_ASPECT ? 0 : (width - resizedWidth) / 2;
+        int dy = resizeMode == RESIZE_KEEP_ASPECT ? 0 : (height - resizedHeight) / 2;
+        area = cv::Rect(dx, dy, resizedWidth, resizedHeight);
+    }
+
+    cv::Mat target = dst(area);
+    if (area.size() == mat.size()) {
+        mat.copyTo(target);
+    } else {
+        cv::resize(mat, target, area.size(), 0, 0, interpMode);
+    }
+
+    // Fill only the border strips around the resized image
+    const cv::Scalar borderValue(0, 0, 0);
+    const cv::Rect borders[] = {
+        cv::Rect(0, 0, width, area.y),
+        cv::Rect(0, area.y + area.height, width, height - area.y - area.height),
+        cv::Rect(0, area.y, area.x, area.height),
+        cv::Rect(area.x + area.width, area.y, width - area.x - area.width, area.height)
+    };
+    for (const auto& border : borders) {
+        if (border.area() > 0) {
+            dst(border).setTo(borderValue);
+        }
+    }
+
+    if (roi) {
+        *roi = area;
+    }
+    if (scale) {
+        *scale = cv::Point2f(static_cast<float>(area.width) / mat.cols, static_cast<float>(area.height) / mat.rows);
+    }
+}
+
+cv::Mat bgrToNV12(const cv::Mat& bgr) {
+    cv::Mat nv12;
+    bgrToNV12(bgr, nv12);
+    return nv12;
+}
+
+void bgrToNV12(const cv::Mat& bgr, cv::Mat& nv12) {
+    const int width = bgr.cols & ~1;
+    const int height = bgr.rows & ~1;
+    if (width == 0 || height == 0) {
+        throw std::invalid_argument("The image is too small for NV12");
+    }
+    // Every frame of a stream converts through a buffer of one size, kept per thread
+    thread_local cv::Mat i420;
+    cv::cvtColor(bgr(cv::Rect(0, 0, width, height)), i420, cv::COLOR_BGR2YUV_I420);
+    nv12.create(height * 3 / 2, width, CV_8UC1);
+    i420.rowRange(0, height).copyTo(nv12.rowRange(0, height));
+    //--- I420 keeps U and V in planes of their own, NV12 interleaves them
+    const uchar* u = i420.ptr(height);
+    const uchar* v = u + width * height / 4;
+    uchar* uv = nv12.ptr(height);
+    for (int i = 0; i < width * height / 4; ++i) {
+        uv[2 * i] = u[i];
+        uv[2 * i + 1] = v[i];
+    }
+}
+
+cv::Mat nv12ToBGR(const cv::Mat& nv12, cv::Rect roi, cv::Rect* alignedRoi) {
+    const cv::Size size = nv12Size(nv12);
+    if (roi.empty()) {
+        roi = cv::Rect(cv::Point(), size);
+    }
+    const int x0 = roi.x & ~1;
+    const int y0 = roi.y & ~1;
+    const int x1 = std::min(roi.x + roi.width + 1, size.width) & ~1;
+    const int y1 = std::min(roi.y + roi.height + 1, size.height) & ~1;
+    roi = cv::Rect(x0, y0, x1 - x0, y1 - y0);
+    if (alignedRoi) {
+        *alignedRoi = roi;
+    }
+    if (roi.empty()) {
+        return cv::Mat();
+    }
+    const cv::Mat y(roi.height, roi.width, CV_8UC1, const_cast<uchar*>(nv12.ptr(roi.y)) + roi.x, nv12.step);
+    const cv::Mat uv(roi.height / 2, roi.width / 2, CV_8UC2, const_cast<uchar*>(nv12.ptr(size.height + roi.y / 2)) + roi.x, nv12.step);
+    cv::Mat bgr;
+    cv::cvtColorTwoPlane(y, uv, bgr, cv::COLOR_YUV2BGR_NV12);
+    return bgr;
+}
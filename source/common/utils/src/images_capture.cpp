@@ -3,6 +3,7 @@
 //
 
 #include <utils/images_capture.h>
+#include <utils/image_utils.h>
 
 #ifdef _WIN32
 #include "w_dirent.hpp"
@@ -11,11 +12,20 @@
 #endif
 
 #include <opencv2/imgcodecs.hpp>
-
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <map>
 #include <stdexcept>
 #include <string>
 #include <memory>
 #include <fstream>
+#include <thread>
 
 class InvalidInput : public std::runtime_error {
 public:
@@ -29,23 +39,126 @@ public:
         : std::runtime_error(message) {}
 };
 
+int reducedDecodeScale(cv::Size source, cv::Size target) {
+    if (target.empty()) return 1;
+    for (int scale : {8, 4, 2}) {
+        if (source.width / scale >= target.width && source.height / scale >= target.height) return scale;
+    }
+    return 1;
+}
+
+namespace {
+int imreadFlags(int scale) {
+    switch (scale) {
+        case 2: return cv::IMREAD_REDUCED_COLOR_2;
+        case 4: return cv::IMREAD_REDUCED_COLOR_4;
+        case 8: return cv::IMREAD_REDUCED_COLOR_8;
+        default: return cv::IMREAD_COLOR;
+    }
+}
+
+// Size of the source decoded reduced by scale, rounded up as by decoders
+cv::Size reducedSize(cv::Size source, int scale) {
+    return {(source.width + scale - 1) / scale, (source.height + scale - 1) / scale};
+}
+
+uint32_t readBigEndian(const unsigned char* bytes, int count) {
+    uint32_t value = 0;
+    for (int i = 0; i < count; ++i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+// Size of a JPEG or PNG image read from its header without decoding, empty for other formats or a broken header.
+// EXIF orientation is not applied, so width and height of a rotated JPEG come swapped
+cv::Size headerImageSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char bytes[24];
+    if (!file.read(reinterpret_cast<char*>(bytes), 2)) return {};
+
+    if (bytes[0] == 0x89 && bytes[1] == 'P') {
+        // PNG signature and the IHDR chunk, which comes first
+        if (!file.read(reinterpret_cast<char*>(bytes + 2), 22) || std::memcmp(bytes + 12, "IHDR", 4)) return {};
+        return {static_cast<int>(readBigEndian(bytes + 16, 4)), static_cast<int>(readBigEndian(bytes + 20, 4))};
+    }
+    if (bytes[0] != 0xFF || bytes[1] != 0xD8) return {};
+
+    // JPEG markers up to the start of frame, which holds the size. Markers without a segment are skipped
+    while (file.read(reinterpret_cast<char*>(bytes), 1)) {
+        if (bytes[0] != 0xFF) return {};
+        unsigned char marker = 0xFF;
+        while (marker == 0xFF && file.read(reinterpret_cast<char*>(&marker), 1)) {}
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue;
+        if (marker == 0xD9 || marker == 0xDA || !file.read(reinterpret_cast<char*>(bytes), 2)) return {};
+        const uint32_t length = readBigEndian(bytes, 2);
+        const bool startOfFrame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (startOfFrame) {
+            // Precision, height and width
+            if (!file.read(reinterpret_cast<char*>(bytes), 5)) return {};
+            return {static_cast<int>(readBigEndian(bytes + 3, 2)), static_cast<int>(readBigEndian(bytes + 1, 2))};
+        }
+        if (length < 2) return {};
+        file.seekg(length - 2, std::ios::cur);
+    }
+    return {};
+}
+
+// Extensions of formats cv::imread() may decode, depending on how OpenCV is built. Files are told by name only,
+// so listing a folder reads no file; files that fail to decode are skipped when read
+bool hasImageExtension(const std::string& name) {
+    static const char* const extensions[] = {"bmp", "dib", "jpeg", "jpg", "jpe", "jp2", "png", "webp", "avif", "gif", "pbm",
+        "pgm", "ppm", "pxm", "pnm", "pfm", "sr", "ras", "tiff", "tif", "exr", "hdr", "pic"};
+    const auto dot = name.rfind('.');
+    if (dot == std::string::npos) return false;
+    std::string extension = name.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return std::find(std::begin(extensions), std::end(extensions), extension) != std::end(extensions);
+}
+
+// Per-frame conversion of a stream, into a pooled buffer instead of a fresh one
+cv::Mat pooledNV12(const cv::Mat& bgr, FrameBufferPool& pool) {
+    cv::Mat nv12 = pool.acquire(bgrToNV12Size(bgr), CV_8UC1);
+    bgrToNV12(bgr, nv12);
+    return nv12;
+}
+}  // namespace
+
 class ImreadWrapper : public ImagesCapture {
     cv::Mat img;
     bool canRead;
 
 public:
-    ImreadWrapper(const std::string &input, bool loop) : ImagesCapture{loop}, canRead{true} {
+    ImreadWrapper(const std::string &input, bool loop, cv::Size decodeSize, bool nv12) : ImagesCapture{loop}, canRead{true} {
         auto startTime = std::chrono::steady_clock::now();
 
         std::ifstream file(input.c_str());
         if (!file.good())
             throw InvalidInput("Can't find the image by " + input);
 
-        img = cv::imread(input);
+        // The size of JPEG and PNG images comes from the header, so the image is decoded once, reduced for smaller
+        // copies on every read. Other images are decoded fully and downscaled
+        const cv::Size header = decodeSize.empty() ? cv::Size{} : headerImageSize(input);
+        const int scale = reducedDecodeScale(header, decodeSize);
+        img = cv::imread(input, imreadFlags(scale));
         if(!img.data)
             throw OpenError("Can't open the image from " + input);
-        else
-            readerMetrics.update(startTime);
+        if (scale > 1) {
+            // The longer sides match whether or not imread rotated the image by its EXIF orientation
+            sourceScale = static_cast<double>(std::max(header.width, header.height)) / std::max(img.cols, img.rows);
+        } else if (header.empty()) {
+            const int fullScale = reducedDecodeScale(img.size(), decodeSize);
+            if (fullScale > 1) {
+                const cv::Size source = img.size();
+                cv::resize(img, img, reducedSize(source, fullScale), 0, 0, cv::INTER_AREA);
+                sourceScale = static_cast<double>(source.width) / img.cols;
+            }
+        }
+        if (nv12) {
+            img = bgrToNV12(img);
+        }
+        readerMetrics.update(startTime);
     }
 
     double fps() const override {return 1.0;}
@@ -53,26 +166,142 @@ public:
     std::string getType() const override {return "IMAGE";}
 
     cv::Mat read() override {
-        if (loop) return img.clone();
+        if (loop) return framePool->copy(img);
         if (canRead) {
             canRead = false;
-            return img.clone();
+            return framePool->copy(img);
         }
         return cv::Mat{};
     }
 };
 
+// Decodes images of a sequence on a pool of threads, at most window images ahead of the consumer,
+// and hands them out in sequence order
+class ParallelDecoder {
+public:
+    // pathOf(seq) returns the path of the seq-th image or an empty string past the end, from any thread
+    ParallelDecoder(std::function<std::string(size_t)> pathOf, size_t threadNum, size_t window, int flags = cv::IMREAD_COLOR,
+            bool nv12 = false) :
+            pathOf{std::move(pathOf)}, window{window}, flags{flags}, nv12{nv12}, nextTask{0}, nextSeq{0}, endSeq{std::numeric_limits<size_t>::max()},
+            stop{false}, stats{} {
+        if (threadNum == 0 || window == 0) {
+            throw std::runtime_error("Parallel decoding needs at least one thread and one image ahead");
+        }
+        for (size_t i = 0; i < threadNum; ++i) {
+            workers.emplace_back(&ParallelDecoder::work, this);
+        }
+    }
+
+    ~ParallelDecoder() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        room.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Returns false at the end. img is empty if the image failed to decode
+    bool next(cv::Mat& img) {
+        std::unique_lock<std::mutex> lock(mtx);
+        auto found = decoded.find(nextSeq);
+        if (found == decoded.end() && nextSeq < endSeq) {
+            auto waitStart = std::chrono::steady_clock::now();
+            ready.wait(lock, [this] { return decoded.count(nextSeq) || nextSeq >= endSeq; });
+            ++stats.consumerStalls;
+            stats.consumerStallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+            found = decoded.find(nextSeq);
+        }
+        if (found == decoded.end()) {
+            return false;
+        }
+        img = std::move(found->second);
+        decoded.erase(found);
+        ++nextSeq;
+        lock.unlock();
+        room.notify_all();
+        return true;
+    }
+
+    PrefetchStats getStats() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        PrefetchStats result = stats;
+        result.decodeMs = stats.frames ? stats.decodeMs / stats.frames : 0.0;
+        return result;
+    }
+
+private:
+    void work() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            auto hasTask = [this] { return stop || nextTask >= endSeq || nextTask < nextSeq + window; };
+            if (!hasTask()) {
+                auto waitStart = std::chrono::steady_clock::now();
+                room.wait(lock, hasTask);
+                ++stats.decoderStalls;
+                stats.decoderStallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+            }
+            if (stop || nextTask >= endSeq) {
+                return;
+            }
+            const size_t seq = nextTask++;
+            lock.unlock();
+
+            const std::string path = pathOf(seq);
+            auto startTime = std::chrono::steady_clock::now();
+            cv::Mat img = path.empty() ? cv::Mat{} : cv::imread(path, flags);
+            if (nv12 && img.data) {
+                img = bgrToNV12(img);
+            }
+            std::chrono::duration<double, std::milli> decodeTime = std::chrono::steady_clock::now() - startTime;
+
+            lock.lock();
+            if (path.empty()) {
+                endSeq = std::min(endSeq, seq);
+                room.notify_all();
+            } else {
+                decoded.emplace(seq, std::move(img));
+                ++stats.frames;
+                stats.decodeMs += decodeTime.count();
+            }
+            ready.notify_one();
+        }
+    }
+
+    const std::function<std::string(size_t)> pathOf;
+    const size_t window;
+    const int flags;  // cv::imread() flags
+    const bool nv12;  // Decoded images are converted to NV12 by workers
+    mutable std::mutex mtx;
+    std::condition_variable ready;
+    std::condition_variable room;
+    std::map<size_t, cv::Mat> decoded;  // Out of order results of workers, by sequence number
+    size_t nextTask;
+    size_t nextSeq;
+    size_t endSeq;
+    bool stop;
+    PrefetchStats stats;
+    std::vector<std::thread> workers;
+};
+
 class DirReader : public ImagesCapture {
-    std::vector<std::string> names;
+    std::vector<std::string> names;  // Files of image extensions, sorted
     size_t fileId;
     size_t nextImgId;
     const size_t initialImageId;
     const size_t readLengthLimit;
     const std::string input;
+    int flags;  // cv::imread() flags, reduced decoding if requested
+    const bool nv12;
+    std::unique_ptr<ParallelDecoder> decoder;  // Set in prefetch mode
 
 public:
-    DirReader(const std::string &input, bool loop, size_t initialImageId, size_t readLengthLimit) : ImagesCapture{loop},
-            fileId{0}, nextImgId{0}, initialImageId{initialImageId}, readLengthLimit{readLengthLimit}, input{input} {
+    DirReader(const std::string &input, bool loop, size_t initialImageId, size_t readLengthLimit, read_type type = read_type::efficient,
+            size_t prefetchDepth = 4, size_t decodeThreads = 0, cv::Size decodeSize = {}, bool nv12 = false) : ImagesCapture{loop},
+            fileId{initialImageId}, nextImgId{0}, initialImageId{initialImageId}, readLengthLimit{readLengthLimit}, input{input},
+            flags{cv::IMREAD_COLOR}, nv12{nv12} {
         DIR *dir = opendir(input.c_str());
         if (!dir)
             throw InvalidInput("Can't find the dir by " + input);
@@ -83,50 +312,83 @@ public:
         if (names.empty())
             throw OpenError("The dir " + input + " is empty");
         sort(names.begin(), names.end());
-        size_t readImgs = 0;
-        while (fileId < names.size()) {
-            cv::Mat img = cv::imread(input + '/' + names[fileId]);
-            if (img.data) {
-                ++readImgs;
-                if (readImgs - 1 >= initialImageId) return;
+        // Images are recognized by their extensions, so neither listing nor seeking to initialImageId opens a file
+        names.erase(std::remove_if(names.begin(), names.end(),
+            [](const std::string& name) { return !hasImageExtension(name); }), names.end());
+        if (names.size() <= initialImageId)
+            throw OpenError("Can't read the first image from " + input);
+
+        if (!decodeSize.empty()) {
+            // The size of the first image comes from its header. Other formats are decoded reduced by 8, which is
+            // the size over 8 rounded up, so the size is estimated up to 7 pixels
+            const std::string firstPath = input + '/' + names[initialImageId];
+            cv::Size first = headerImageSize(firstPath);
+            if (first.empty()) {
+                const cv::Mat reduced = cv::imread(firstPath, cv::IMREAD_REDUCED_COLOR_8);
+                first = reduced.size() * 8;
+            }
+            if (!first.empty()) {
+                const int scale = reducedDecodeScale(first, decodeSize);
+                flags = imreadFlags(scale);
+                sourceScale = static_cast<double>(first.width) / reducedSize(first, scale).width;
             }
-            ++fileId;
         }
-        throw OpenError("Can't read the first image from " + input);
+
+        if (type == read_type::prefetch) {
+            // Every pass of a loop reads the same images, so the sequence maps onto them without rescanning the dir
+            const size_t passLength = std::min(readLengthLimit, names.size() - initialImageId);
+            auto pathOf = [this, passLength](size_t seq) {
+                if (!this->loop && seq >= passLength) return std::string{};
+                return this->input + '/' + names[this->initialImageId + seq % passLength];
+            };
+            if (decodeThreads == 0) {
+                decodeThreads = std::max<size_t>(1, std::min<size_t>(prefetchDepth, std::thread::hardware_concurrency()));
+            }
+            decoder.reset(new ParallelDecoder{pathOf, decodeThreads, prefetchDepth, flags, nv12});
+        }
     }
 
     double fps() const override {return 1.0;}
 
     std::string getType() const override {return "DIR";}
 
+    bool getPrefetchStats(PrefetchStats& stats) const override {
+        if (!decoder) return false;
+        stats = decoder->getStats();
+        return true;
+    }
+
     cv::Mat read() override {
         auto startTime = std::chrono::steady_clock::now();
 
-        while (fileId < names.size() && nextImgId < readLengthLimit) {
-            cv::Mat img = cv::imread(input + '/' + names[fileId]);
-            ++fileId;
-            if (img.data) {
-                ++nextImgId;
-                readerMetrics.update(startTime);
-                return img;
+        if (decoder) {
+            // A pass of failed decodes in a row means no image decodes, so the input ends instead of looping forever
+            cv::Mat img;
+            for (size_t failed = 0; failed <= names.size() && decoder->next(img); ++failed) {
+                if (img.data) {
+                    readerMetrics.update(startTime);
+                    return img;
+                }
             }
+            return cv::Mat{};
         }
 
-        if (loop) {
-            fileId = 0;
-            size_t readImgs = 0;
-            while (fileId < names.size()) {
-                cv::Mat img = cv::imread(input + '/' + names[fileId]);
+        for (int pass = 0; pass < 2; ++pass) {
+            while (fileId < names.size() && nextImgId < readLengthLimit) {
+                cv::Mat img = cv::imread(input + '/' + names[fileId], flags);
                 ++fileId;
                 if (img.data) {
-                    ++readImgs;
-                    if (readImgs - 1 >= initialImageId) {
-                        nextImgId = 1;
-                        readerMetrics.update(startTime);
-                        return img;
+                    if (nv12) {
+                        img = bgrToNV12(img);
                     }
+                    ++nextImgId;
+                    readerMetrics.update(startTime);
+                    return img;
                 }
             }
+            if (!loop) break;
+            fileId = initialImageId;
+            nextImgId = 0;
         }
         return cv::Mat{};
     }
@@ -139,10 +401,31 @@ class VideoCapWrapper : public ImagesCapture {
     size_t nextImgId;
     const double initialImageId;
     size_t readLengthLimit;
+    const bool nv12;
+    cv::Size frameSize;  // Of the stream, as the backend reports it
+
+    // Safe frames are copied
+    cv::Mat output(const cv::Mat& img) {
+        if (nv12 && img.data) {
+            if (img.type() == CV_8UC3) {
+                // The backend converted the frame anyway
+                return pooledNV12(img, *framePool);
+            }
+            // Y and UV planes of the stream frame. A gray frame of one plane has the stream height, not 3/2 of it,
+            // and a stream of unknown size can't tell the two apart
+            if (img.type() != CV_8UC1 || frameSize.empty() || img.cols != frameSize.width
+                    || img.rows != frameSize.height * 3 / 2) {
+                throw std::runtime_error("The video backend returned a frame that is neither BGR nor NV12");
+            }
+        }
+        return type != read_type::efficient ? framePool->copy(img) : img;
+    }
 
 public:
-    VideoCapWrapper(const std::string &input, bool loop, read_type type, size_t initialImageId, size_t readLengthLimit)
-            : ImagesCapture{loop}, first_read{true}, type{type}, nextImgId{0}, initialImageId{static_cast<double>(initialImageId)} {
+    VideoCapWrapper(const std::string &input, bool loop, read_type type, size_t initialImageId, size_t readLengthLimit,
+            bool nv12 = false)
+            : ImagesCapture{loop}, first_read{true}, type{type}, nextImgId{0}, initialImageId{static_cast<double>(initialImageId)},
+            nv12{nv12} {
         if (0 == readLengthLimit) {
             throw std::runtime_error("readLengthLimit must be positive");
         }
@@ -150,6 +433,11 @@ public:
             this->readLengthLimit = readLengthLimit;
             if (!cap.set(cv::CAP_PROP_POS_FRAMES, this->initialImageId))
                 throw OpenError("Can't set the frame to begin with");
+            if (nv12) {
+                cap.set(cv::CAP_PROP_CONVERT_RGB, false);
+                frameSize = cv::Size(static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT)));
+            }
             return;
         }
         throw InvalidInput("Can't open the video from " + input);
@@ -167,9 +455,7 @@ public:
                 nextImgId = 1;
                 cv::Mat img;
                 cap.read(img);
-                if (type == read_type::safe) {
-                    img = img.clone();
-                }
+                img = output(img);
                 readerMetrics.update(startTime);
                 return img;
             }
@@ -187,9 +473,7 @@ public:
         } else {
             ++nextImgId;
         }
-        if (type == read_type::safe) {
-            img = img.clone();
-        }
+        img = output(img);
         readerMetrics.update(startTime);
         return img;
     }
@@ -200,11 +484,12 @@ class CameraCapWrapper : public ImagesCapture {
     const read_type type;
     size_t nextImgId;
     size_t readLengthLimit;
+    const bool nv12;
 
 public:
     CameraCapWrapper(const std::string &input, bool loop, read_type type,
-                size_t readLengthLimit, cv::Size cameraResolution)
-            : ImagesCapture{loop}, type{type}, nextImgId{0} {
+                size_t readLengthLimit, cv::Size cameraResolution, bool nv12 = false)
+            : ImagesCapture{loop}, type{type}, nextImgId{0}, nv12{nv12} {
         if (0 == readLengthLimit) {
             throw std::runtime_error("readLengthLimit must be positive");
         }
@@ -238,8 +523,10 @@ public:
         if (!cap.read(img)) {
             throw std::runtime_error("The image can't be captured from the camera");
         }
-        if (type == read_type::safe) {
-            img = img.clone();
+        if (nv12) {
+            img = pooledNV12(img, *framePool);
+        } else if (type != read_type::efficient) {
+            img = framePool->copy(img);
         }
         ++nextImgId;
 
@@ -248,23 +535,302 @@ public:
     }
 };
 
+// Generated frames for benchmarks, no files or devices needed. Input is
+// synthetic:<width>x<height>[@<fps>][:<pattern>[:<frames>]], e.g. synthetic:1920x1080@30:bars:1000.
+// Patterns are bars (default), noise and black. Bars and noise move by a few pixels every frame.
+// Without fps frames are generated as fast as they are read, without frames the stream is endless.
+// Every frame is a pooled copy, so readers see distinct buffers as from a decoder. NV12 frames are windows
+// of the canvas converted once, their size is rounded down to even
+class SyntheticCapture : public ImagesCapture {
+    cv::Mat canvas;  // Pattern twice as wide as the frame, frames are windows sliding over it
+    cv::Size frameSize;
+    const bool nv12;
+    double framesPerSecond;
+    size_t frameNum;
+    size_t nextImgId;
+    const size_t initialImageId;
+    std::chrono::steady_clock::time_point firstFrameTime;
+
+public:
+    static constexpr const char* prefix = "synthetic:";
+
+    SyntheticCapture(const std::string &input, bool loop, size_t initialImageId, size_t readLengthLimit, bool nv12 = false) :
+            ImagesCapture{loop}, nv12{nv12}, framesPerSecond{0.0}, frameNum{std::numeric_limits<size_t>::max()}, nextImgId{initialImageId}, initialImageId{initialImageId} {
+        if (input.compare(0, strlen(prefix), prefix) != 0)
+            throw InvalidInput("Not a synthetic input " + input);
+        std::vector<std::string> fields;
+        size_t begin = strlen(prefix);
+        for (size_t end; (end = input.find(':', begin)) != std::string::npos; begin = end + 1) {
+            fields.push_back(input.substr(begin, end - begin));
+        }
+        fields.push_back(input.substr(begin));
+
+        std::string pattern = fields.size() > 1 ? fields[1] : "bars";
+        try {
+            size_t pos;
+            frameSize.width = std::stoi(fields[0], &pos);
+            if (fields[0][pos] != 'x')
+                throw std::invalid_argument("size");
+            size_t heightPos = pos + 1;
+            frameSize.height = std::stoi(fields[0].substr(heightPos), &pos);
+            if (heightPos + pos < fields[0].size()) {
+                if (fields[0][heightPos + pos] != '@')
+                    throw std::invalid_argument("fps");
+                framesPerSecond = std::stod(fields[0].substr(heightPos + pos + 1));
+            }
+            if (fields.size() > 2)
+                frameNum = std::stoul(fields[2]);
+        } catch (const std::logic_error&) {
+            throw OpenError("Can't parse the synthetic input " + input +
+                ", expected synthetic:<width>x<height>[@<fps>][:<pattern>[:<frames>]]");
+        }
+        if (nv12) {
+            frameSize.width &= ~1;
+            frameSize.height &= ~1;
+        }
+        if (frameSize.width <= 0 || frameSize.height <= 0 || framesPerSecond < 0.0 || frameNum == 0)
+            throw OpenError("Invalid size, fps or number of frames of the synthetic input " + input);
+        if (initialImageId >= frameNum)
+            throw OpenError("The synthetic input " + input + " has no frame " + std::to_string(initialImageId));
+        if (readLengthLimit < frameNum - initialImageId)
+            frameNum = initialImageId + readLengthLimit;
+
+        canvas.create(frameSize.height, 2 * frameSize.width, CV_8UC3);
+        if (pattern == "bars") {
+            static const cv::Scalar colors[] = {{255, 255, 255}, {0, 255, 255}, {255, 255, 0}, {0, 255, 0},
+                                                {255, 0, 255}, {0, 0, 255}, {255, 0, 0}, {0, 0, 0}};
+            const int barNum = sizeof(colors) / sizeof(colors[0]);
+            for (int x = 0; x < canvas.cols; ++x) {
+                canvas.col(x).setTo(colors[x * barNum / frameSize.width % barNum]);
+            }
+        } else if (pattern == "noise") {
+            cv::randu(canvas, cv::Scalar::all(0), cv::Scalar::all(256));
+        } else if (pattern == "black") {
+            canvas.setTo(cv::Scalar::all(0));
+        } else {
+            throw OpenError("Unknown synthetic pattern " + pattern + ", expected bars, noise or black");
+        }
+        if (nv12) {
+            canvas = bgrToNV12(canvas);
+        }
+    }
+
+    double fps() const override {return framesPerSecond > 0 ? framesPerSecond : 30;}
+
+    std::string getType() const override {return "SYNTHETIC";}
+
+    cv::Mat read() override {
+        if (nextImgId >= frameNum) {
+            if (!loop) return cv::Mat{};
+            nextImgId = initialImageId;
+        }
+        if (framesPerSecond > 0) {
+            //--- Paced as a camera, frame N is due N / fps after the first one
+            auto now = std::chrono::steady_clock::now();
+            if (firstFrameTime == std::chrono::steady_clock::time_point{}) {
+                firstFrameTime = now;
+            }
+            auto dueTime = firstFrameTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>((nextImgId - initialImageId) / framesPerSecond));
+            std::this_thread::sleep_until(dueTime);
+        }
+        auto startTime = std::chrono::steady_clock::now();
+        // Even steps keep NV12 windows aligned to chroma samples
+        const int step = std::max(2, frameSize.width / 120) & ~1;
+        const int offset = static_cast<int>(nextImgId * step % frameSize.width);
+        cv::Mat img = framePool->copy(canvas(cv::Rect(offset, 0, frameSize.width, canvas.rows)));
+        ++nextImgId;
+        readerMetrics.update(startTime);
+        return img;
+    }
+};
+
+ReadAheadCapture::ReadAheadCapture(std::unique_ptr<ImagesCapture>&& capture, size_t depth) : ImagesCapture{capture->loop},
+        capture{std::move(capture)}, depth{depth}, capFps{this->capture->fps()}, capType{this->capture->getType()},
+        stop{false}, stats{} {
+    sourceScale = this->capture->getSourceScale();
+    if (depth == 0) {
+        throw std::runtime_error("Read ahead depth must be positive");
+    }
+    // Frames ahead, the one being decoded and a few held by the caller
+    setFramePool(std::make_shared<FrameBufferPool>(depth + 4));
+    decoder = std::thread(&ReadAheadCapture::decode, this);
+}
+
+ReadAheadCapture::~ReadAheadCapture() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    roomReady.notify_one();
+    decoder.join();
+}
+
+void ReadAheadCapture::setFramePool(const std::shared_ptr<FrameBufferPool>& pool) {
+    std::lock_guard<std::mutex> lock(captureMtx);
+    framePool = pool;
+    capture->setFramePool(pool);
+}
+
+void ReadAheadCapture::decode() {
+    while (true) {
+        cv::Mat img;
+        try {
+            std::lock_guard<std::mutex> lock(captureMtx);
+            auto startTime = std::chrono::steady_clock::now();
+            img = capture->read();
+            std::chrono::duration<double, std::milli> decodeTime = std::chrono::steady_clock::now() - startTime;
+            std::lock_guard<std::mutex> statsLock(mtx);
+            stats.decodeMs += decodeTime.count();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mtx);
+            error = std::current_exception();
+            frameReady.notify_one();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mtx);
+        if (frames.size() >= depth && !stop) {
+            auto waitStart = std::chrono::steady_clock::now();
+            roomReady.wait(lock, [this] { return frames.size() < depth || stop; });
+            ++stats.decoderStalls;
+            stats.decoderStallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+        }
+        if (stop) {
+            return;
+        }
+        bool end = img.empty();
+        if (!end) {
+            ++stats.frames;
+        }
+        frames.push_back(std::move(img));
+        lock.unlock();
+        frameReady.notify_one();
+        if (end) {
+            return;
+        }
+    }
+}
+
+cv::Mat ReadAheadCapture::read() {
+    auto startTime = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mtx);
+    if (frames.empty() && !error) {
+        frameReady.wait(lock, [this] { return !frames.empty() || error; });
+        ++stats.consumerStalls;
+        stats.consumerStallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+    if (frames.empty()) {
+        std::rethrow_exception(error);
+    }
+    cv::Mat img = frames.front();
+    if (img.empty()) {
+        // The end stays queued, so later reads return it as well
+        return img;
+    }
+    frames.pop_front();
+    lock.unlock();
+    roomReady.notify_one();
+    readerMetrics.update(startTime);
+    return img;
+}
+
+bool ReadAheadCapture::getPrefetchStats(PrefetchStats& result) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    result = stats;
+    result.decodeMs = stats.frames ? stats.decodeMs / stats.frames : 0.0;
+    return true;
+}
+
+std::vector<VideoSegment> splitVideo(const std::string &input, size_t n) {
+    if (n == 0) throw std::runtime_error{"Number of segments must be positive"};
+    std::vector<size_t> keyframes;
+    size_t frameNum = 0;
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+    // Raw packets are grabbed without decoding. They come in decoding order, which differs from presentation order
+    // with B-frames, so a keyframe begins its segment at the rank of its PTS among all packets
+    cv::VideoCapture raw;
+    if (raw.open(input, cv::CAP_FFMPEG, {cv::CAP_PROP_FORMAT, -1})) {
+        std::vector<double> pts;
+        std::vector<size_t> keyPackets;
+        while (raw.grab()) {
+            if (raw.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0) {
+                keyPackets.push_back(pts.size());
+            }
+            pts.push_back(raw.get(cv::CAP_PROP_PTS));
+        }
+        frameNum = pts.size();
+        std::vector<double> presentation = pts;
+        std::sort(presentation.begin(), presentation.end());
+        // Packets without timestamps or with repeated ones can't be ordered, such videos are split evenly
+        if (std::adjacent_find(presentation.begin(), presentation.end()) == presentation.end()) {
+            for (size_t packet : keyPackets) {
+                keyframes.push_back(std::lower_bound(presentation.begin(), presentation.end(), pts[packet]) - presentation.begin());
+            }
+            std::sort(keyframes.begin(), keyframes.end());
+        }
+    }
+#endif
+    if (frameNum == 0) {
+        cv::VideoCapture cap;
+        if (!cap.open(input))
+            throw std::runtime_error("Can't open the video from " + input);
+        // The count of some containers is an estimate, the last segment reads to the end anyway
+        frameNum = static_cast<size_t>(std::max(0.0, cap.get(cv::CAP_PROP_FRAME_COUNT)));
+        if (frameNum == 0)
+            throw std::runtime_error("Can't get the number of frames of " + input);
+        keyframes.clear();
+    }
+
+    std::vector<size_t> starts{0};
+    for (size_t i = 1; i < n; ++i) {
+        size_t start = i * frameNum / n;
+        if (!keyframes.empty()) {
+            // The nearest keyframe
+            auto next = std::lower_bound(keyframes.begin(), keyframes.end(), start);
+            if (next == keyframes.end() || (next != keyframes.begin() && start - *(next - 1) < *next - start)) {
+                --next;
+            }
+            start = *next;
+        }
+        if (start > starts.back()) {
+            starts.push_back(start);
+        }
+    }
+    std::vector<VideoSegment> segments;
+    for (size_t i = 0; i < starts.size(); ++i) {
+        segments.push_back({starts[i], i + 1 < starts.size() ? starts[i + 1] - starts[i] : std::numeric_limits<size_t>::max()});
+    }
+    return segments;
+}
+
 std::unique_ptr<ImagesCapture> openImagesCapture(const std::string &input, bool loop,
-        read_type type, size_t initialImageId, size_t readLengthLimit, cv::Size cameraResolution) {
+        read_type type, size_t initialImageId, size_t readLengthLimit, cv::Size cameraResolution, size_t prefetchDepth, size_t decodeThreads,
+        cv::Size decodeSize, bool nv12) {
     if (readLengthLimit == 0) throw std::runtime_error{"Read length limit must be positive"};
     std::vector<std::string> invalidInputs, openErrors;
-    try { return std::unique_ptr<ImagesCapture>(new ImreadWrapper{input, loop}); }
+    if (input.compare(0, strlen(SyntheticCapture::prefix), SyntheticCapture::prefix) == 0) {
+        return std::unique_ptr<ImagesCapture>(new SyntheticCapture{input, loop, initialImageId, readLengthLimit, nv12});
+    }
+    try { return std::unique_ptr<ImagesCapture>(new ImreadWrapper{input, loop, decodeSize, nv12}); }
     catch (const InvalidInput& e) { invalidInputs.push_back(e.what()); }
     catch (const OpenError& e) { openErrors.push_back(e.what()); }
 
-    try { return std::unique_ptr<ImagesCapture>(new DirReader{input, loop, initialImageId, readLengthLimit}); }
+    try { return std::unique_ptr<ImagesCapture>(new DirReader{input, loop, initialImageId, readLengthLimit, type, prefetchDepth, decodeThreads, decodeSize, nv12}); }
     catch (const InvalidInput& e) { invalidInputs.push_back(e.what()); }
     catch (const OpenError& e) { openErrors.push_back(e.what()); }
 
-    try { return std::unique_ptr<ImagesCapture>(new VideoCapWrapper{input, loop, type, initialImageId, readLengthLimit}); }
+    try {
+        if (type == read_type::prefetch) {
+            return std::unique_ptr<ImagesCapture>(new ReadAheadCapture{std::unique_ptr<ImagesCapture>(
+                new VideoCapWrapper{input, loop, read_type::safe, initialImageId, readLengthLimit, nv12}), prefetchDepth});
+        }
+        return std::unique_ptr<ImagesCapture>(new VideoCapWrapper{input, loop, type, initialImageId, readLengthLimit, nv12});
+    }
     catch (const InvalidInput& e) { invalidInputs.push_back(e.what()); }
     catch (const OpenError& e) { openErrors.push_back(e.what()); }
 
-    try { return std::unique_ptr<ImagesCapture>(new CameraCapWrapper{input, loop, type, readLengthLimit, cameraResolution}); }
+    try { return std::unique_ptr<ImagesCapture>(new CameraCapWrapper{input, loop, type, readLengthLimit, cameraResolution, nv12}); }
     catch (const InvalidInput& e) { invalidInputs.push_back(e.what()); }
     catch (const OpenError& e) { openErrors.push_back(e.what()); }
 
@@ -275,3 +841,68 @@ std::unique_ptr<ImagesCapture> openImagesCapture(const std::string &input, bool
     }
     throw std::runtime_error(errorsInfo);
 }
+
+CachedCapture::CachedCapture(std::function<std::unique_ptr<ImagesCapture>()> opener, bool loop, size_t memoryLimit) :
+        ImagesCapture{loop}, opener{std::move(opener)}, capture{this->opener()}, memoryLimit{memoryLimit},
+        capFps{capture->fps()}, capType{capture->getType()}, bytes{0}, nextFrame{0}, complete{false}, streaming{false}, loops{0} {
+    sourceScale = capture->getSourceScale();
+}
+
+cv::Mat CachedCapture::read() {
+    auto startTime = std::chrono::steady_clock::now();
+
+    if (complete) {
+        if (nextFrame == frames.size()) {
+            if (!loop || frames.empty()) return cv::Mat{};
+            nextFrame = 0;
+            ++loops;
+        }
+        readerMetrics.update(startTime);
+        return frames[nextFrame++];
+    }
+
+    cv::Mat img = capture->read();
+    if (img.empty()) {
+        if (!streaming) {
+            // The first pass is over and all of it is in memory
+            complete = true;
+            capture.reset();
+            return read();
+        }
+        if (!loop) return cv::Mat{};
+        capture = opener();
+        ++loops;
+        img = capture->read();
+        if (img.empty()) return cv::Mat{};
+    }
+
+    if (!streaming) {
+        const size_t size = img.total() * img.elemSize();
+        if (bytes + size <= memoryLimit) {
+            // A tight copy, the reader may reuse its buffer
+            frames.push_back(img.clone());
+            bytes += size;
+            readerMetrics.update(startTime);
+            return frames.back();
+        }
+        streaming = true;
+        std::vector<cv::Mat>().swap(frames);
+        bytes = 0;
+    }
+    img = framePool->copy(img);
+    readerMetrics.update(startTime);
+    return img;
+}
+
+CachedCapture::Stats CachedCapture::getStats() const {
+    return {frames.size(), bytes, complete, streaming, loops};
+}
+
+std::unique_ptr<ImagesCapture> openCachedCapture(const std::string &input, bool loop, size_t memoryLimit,
+        size_t initialImageId, size_t readLengthLimit, cv::Size decodeSize, bool nv12) {
+    auto opener = [input, initialImageId, readLengthLimit, decodeSize, nv12]() {
+        // Frames are copied by CachedCapture, so the reader may keep its buffers
+        return openImagesCapture(input, false, read_type::efficient, initialImageId, readLengthLimit, {1280, 720}, 4, 0, decodeSize, nv12);
+    };
+    return std::unique_ptr<ImagesCapture>(new CachedCapture{opener, loop, memoryLimit});
+}
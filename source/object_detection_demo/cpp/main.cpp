@@ -86,10 +86,17 @@ static const char num_streams_message[] = "Optional. Number of streams to use fo
                                           "throughput mode (for HETERO and MULTI device cases use format "
                                           "<device1>:<nstreams1>,<device2>:<nstreams2> or just <nstreams>)";
 static const char no_show_message[] = "Optional. Don't show output.";
+static const char read_ahead_message[] = "Optional. Number of frames decoded ahead on separate threads, a video on one "
+"thread, images of a folder on one thread per core. 0 decodes frames on the main thread.";
 static const char utilization_monitors_message[] = "Optional. List of monitors to show initially.";
 static const char iou_thresh_output_message[] =
     "Optional. Filtering intersection over union threshold for overlapping boxes.";
 static const char yolo_af_message[] = "Optional. Use advanced postprocessing/filtering algorithm for YOLO.";
+static const char ingraph_pp_message[] = "Optional. Decode boxes and run NMS inside the compiled model instead of "
+                                         "C++ postprocessing. Only for YOLO architecture type.";
+static const char output_precision_message[] = "Optional. Element type of raw model outputs: f32 or f16. f16 skips output "
+                                               "conversion on devices computing in f16. Only for YOLO architecture type "
+                                               "without -ingraph_pp, other models keep f32 outputs.";
 static const char output_resolution_message[] =
     "Optional. Specify the maximum output window resolution "
     "in (width x height) format. Example: 1280x720. Input frame size used by default.";
@@ -117,8 +124,11 @@ DEFINE_uint32(nireq, 0, nireq_message);
 DEFINE_uint32(nthreads, 0, num_threads_message);
 DEFINE_string(nstreams, "", num_streams_message);
 DEFINE_bool(no_show, false, no_show_message);
+DEFINE_uint32(read_ahead, 0, read_ahead_message);
 DEFINE_string(u, "", utilization_monitors_message);
 DEFINE_bool(yolo_af, true, yolo_af_message);
+DEFINE_bool(ingraph_pp, false, ingraph_pp_message);
+DEFINE_string(output_precision, "f32", output_precision_message);
 DEFINE_string(output_resolution, "", output_resolution_message);
 DEFINE_string(anchors, "", anchors_message);
 DEFINE_string(masks, "", masks_message);
@@ -152,9 +162,12 @@ static void showUsage() {
     std::cout << "    -nstreams                 " << num_streams_message << std::endl;
     std::cout << "    -loop                     " << loop_message << std::endl;
     std::cout << "    -no_show                  " << no_show_message << std::endl;
+    std::cout << "    -read_ahead \"<integer>\"   " << read_ahead_message << std::endl;
     std::cout << "    -output_resolution        " << output_resolution_message << std::endl;
     std::cout << "    -u                        " << utilization_monitors_message << std::endl;
     std::cout << "    -yolo_af                  " << yolo_af_message << std::endl;
+    std::cout << "    -ingraph_pp               " << ingraph_pp_message << std::endl;
+    std::cout << "    -output_precision         " << output_precision_message << std::endl;
     std::cout << "    -anchors                  " << anchors_message << std::endl;
     std::cout << "    -masks                    " << masks_message << std::endl;
     std::cout << "    -reverse_input_channels   " << reverse_input_channels_message << std::endl;
@@ -336,7 +349,12 @@ int main(int argc, char* argv[]) {
         } catch (...) { throw std::runtime_error("Invalid masks list is provided."); }
 
         //------------------------------- Preparing Input ------------------------------------------------------
-        auto cap = openImagesCapture(FLAGS_i, FLAGS_loop, FLAGS_nireq == 1 ? read_type::efficient : read_type::safe);
+        read_type readType = FLAGS_nireq == 1 ? read_type::efficient : read_type::safe;
+        if (FLAGS_read_ahead > 0) {
+            readType = read_type::prefetch;
+        }
+        auto cap = openImagesCapture(FLAGS_i, FLAGS_loop, readType, 0, std::numeric_limits<size_t>::max(), {1280, 720},
+                                     FLAGS_read_ahead);
         cv::Mat curr_frame;
 
         //------------------------------ Running Detection routines ----------------------------------------------
@@ -369,20 +387,29 @@ int main(int argc, char* argv[]) {
         } else if (FLAGS_at == "ssd") {
             model.reset(new ModelSSD(FLAGS_m, static_cast<float>(FLAGS_t), FLAGS_auto_resize, labels, FLAGS_layout));
         } else if (FLAGS_at == "yolo") {
-            model.reset(new ModelYolo(FLAGS_m,
-                                      static_cast<float>(FLAGS_t),
-                                      FLAGS_auto_resize,
-                                      FLAGS_yolo_af,
-                                      static_cast<float>(FLAGS_iou_t),
-                                      labels,
-                                      anchors,
-                                      masks,
-                                      FLAGS_layout));
+            ModelYolo* yoloModel = new ModelYolo(FLAGS_m,
+                                                 static_cast<float>(FLAGS_t),
+                                                 FLAGS_auto_resize,
+                                                 FLAGS_yolo_af,
+                                                 static_cast<float>(FLAGS_iou_t),
+                                                 labels,
+                                                 anchors,
+                                                 masks,
+                                                 FLAGS_layout);
+            yoloModel->setInGraphPostprocessing(FLAGS_ingraph_pp);
+            model.reset(yoloModel);
         } else {
             slog::err << "No model type or invalid model type (-at) provided: " + FLAGS_at << slog::endl;
             return -1;
         }
+        if (FLAGS_ingraph_pp && FLAGS_at != "yolo") {
+            slog::warn << "In-graph postprocessing is available for YOLO only, the flag is ignored" << slog::endl;
+        }
+        if (FLAGS_output_precision != "f32" && (FLAGS_at != "yolo" || FLAGS_ingraph_pp)) {
+            slog::warn << "f16 outputs are parsed by YOLO C++ postprocessing only, the flag is ignored" << slog::endl;
+        }
         model->setInputsPreprocessing(FLAGS_reverse_input_channels, FLAGS_mean_values, FLAGS_scale_values);
+        model->setOutputsPrecision(FLAGS_output_precision);
         slog::info << ov::get_openvino_version() << slog::endl;
 
         ov::Core core;
@@ -502,6 +529,13 @@ int main(int argc, char* argv[]) {
                            pipeline.getPostprocessMetrics().getTotal().latency,
                            renderMetrics.getTotal().latency);
         slog::info << presenter.reportMeans() << slog::endl;
+        PrefetchStats stats;
+        if (cap->getPrefetchStats(stats)) {
+            slog::info << "Read ahead: " << stats.frames << " frames, decoding " << std::fixed << std::setprecision(1) <<
+                stats.decodeMs << " ms" << slog::endl;
+            slog::info << "\tWaits for decoding: " << stats.consumerStalls << ", " << stats.consumerStallMs << " ms" << slog::endl;
+            slog::info << "\tWaits of decoder for room ahead: " << stats.decoderStalls << ", " << stats.decoderStallMs << " ms" << slog::endl;
+        }
     } catch (const std::exception& error) {
         slog::err << error.what() << slog::endl;
         return 1;
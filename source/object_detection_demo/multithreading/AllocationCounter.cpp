@@ -0,0 +1,176 @@
+#include <AllocationCounter.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Global operator new and delete are replaced for the whole demo, counting is a thread local increment
+// and a relaxed increment of the process wide counter. Every form of operator new is counted: plain and array,
+// nothrow and, with C++17 aligned allocation, aligned ones
+namespace {
+thread_local uint64_t allocationCount = 0;
+std::atomic<uint64_t> totalCount {0};
+
+void count(){
+    allocationCount++;
+    totalCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Retries with the new handler until it succeeds, as the standard operator new does
+void* allocate(std::size_t size){
+    count();
+    while (true) {
+        if (void* ptr = std::malloc(size ? size : 1)) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+#ifdef __cpp_aligned_new
+void* allocateAligned(std::size_t size, std::align_val_t alignment){
+    count();
+    const std::size_t align = static_cast<std::size_t>(alignment) < sizeof(void*) ? sizeof(void*) : static_cast<std::size_t>(alignment);
+    while (true) {
+#ifdef _WIN32
+        void* ptr = _aligned_malloc(size ? size : 1, align);
+#else
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, align, size ? size : 1) != 0) {
+            ptr = nullptr;
+        }
+#endif
+        if (ptr) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void freeAligned(void* ptr){
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+#endif
+}
+
+uint64_t threadAllocationCount(){
+    return allocationCount;
+}
+
+uint64_t totalAllocationCount(){
+    return totalCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size){
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size){
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept{
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept{
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept{
+    std::free(ptr);
+}
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment){
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment){
+    return allocateAligned(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept{
+    try {
+        return allocateAligned(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept{
+    try {
+        return allocateAligned(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept{
+    freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept{
+    freeAligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept{
+    freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept{
+    freeAligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept{
+    freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept{
+    freeAligned(ptr);
+}
+#endif
@@ -0,0 +1,14 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <cstdint>
+
+// Number of global operator new calls made by the calling thread so far. The difference of two
+// readings around a piece of code tells how many heap allocations it made. Memory allocated bypassing
+// operator new, e.g. by malloc() or cv::Mat buffers of cv::fastMalloc(), is not counted.
+uint64_t threadAllocationCount();
+
+// Number of global operator new calls made by all threads so far
+uint64_t totalAllocationCount();
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef BLOB_POOL_HPP
+#define BLOB_POOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include <inc/api/hvaPipeline.hpp>
+
+// Free lists of raw blocks, one per block size. Backs shared_ptr control blocks and allocate_shared
+// objects of the per-frame hot path, so they stop hitting the heap once every size was seen.
+class BlockArena{
+public:
+    explicit BlockArena(std::size_t blocksPerSize): m_blocksPerSize(blocksPerSize){}
+
+    ~BlockArena(){
+        for (auto& sizeBlocks : m_free) {
+            for (void* block : sizeBlocks.second) {
+                ::operator delete(block);
+            }
+        }
+    }
+
+    void* allocate(std::size_t size){
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& blocks = m_free[size];
+            if (!blocks.empty()) {
+                void* block = blocks.back();
+                blocks.pop_back();
+                return block;
+            }
+            //--- Free list of a new size is reserved once, so returning blocks never reallocates it
+            blocks.reserve(m_blocksPerSize);
+        }
+        m_heapAllocations++;
+        return ::operator new(size);
+    }
+
+    void deallocate(void* block, std::size_t size){
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& blocks = m_free[size];
+            if (blocks.size() < m_blocksPerSize) {
+                blocks.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block);
+    }
+
+    // Blocks taken from the heap because their free list was empty
+    uint64_t heapAllocations() const{
+        return m_heapAllocations;
+    }
+
+private:
+    const std::size_t m_blocksPerSize;
+    std::mutex m_mutex;
+    std::unordered_map<std::size_t, std::vector<void*>> m_free;
+    std::atomic<uint64_t> m_heapAllocations {0};
+};
+
+// Standard allocator over BlockArena, for std::allocate_shared and shared_ptr control blocks.
+// Holds the arena by shared_ptr, as a control block deallocates itself after the owner of the arena may be gone.
+template<typename T>
+class ArenaAllocator{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(std::shared_ptr<BlockArena> arena): m_arena(std::move(arena)){}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other): m_arena(other.arena()){}
+
+    T* allocate(std::size_t n){
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n){
+        m_arena->deallocate(ptr, n * sizeof(T));
+    }
+
+    const std::shared_ptr<BlockArena>& arena() const{
+        return m_arena;
+    }
+
+private:
+    std::shared_ptr<BlockArena> m_arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b){
+    return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b){
+    return !(a == b);
+}
+
+// Reusable hvaBuf_t with its payload and meta allocated once. A buf is returned to the pool by the
+// shared_ptr deleter, i.e. when the last blob holding it is released, and onRelease runs before that
+// to drop references kept by the meta and to signal the owner.
+template<typename T, typename META_T>
+class BufPool : public std::enable_shared_from_this<BufPool<T, META_T>>{
+public:
+    using Buf = hva::hvaBuf_t<T, META_T>;
+    using OnRelease = std::function<void(Buf&)>;
+
+    static std::shared_ptr<BufPool> create(std::size_t capacity, const std::shared_ptr<BlockArena>& arena, OnRelease onRelease = {}){
+        return std::shared_ptr<BufPool>(new BufPool(capacity, arena, std::move(onRelease)));
+    }
+
+    ~BufPool(){
+        for (Buf* buf : m_free) {
+            delete buf;
+        }
+    }
+
+    // Payload and meta keep the content of the previous frame, the caller overwrites them
+    std::shared_ptr<Buf> acquire(){
+        Buf* buf = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_free.empty()) {
+                buf = m_free.back();
+                m_free.pop_back();
+            }
+        }
+        if (!buf) {
+            m_created++;
+            buf = new Buf(new T(), sizeof(T), new META_T());
+        }
+        m_acquired++;
+        return std::shared_ptr<Buf>(buf, Recycler{this->shared_from_this()}, ArenaAllocator<Buf>(m_arena));
+    }
+
+    uint64_t acquired() const{
+        return m_acquired;
+    }
+
+    // Bufs allocated because none was free, capacity is exceeded if it grows past the warm-up
+    uint64_t created() const{
+        return m_created;
+    }
+
+private:
+    struct Recycler{
+        std::shared_ptr<BufPool> pool;
+
+        void operator()(Buf* buf) const{
+            pool->recycle(buf);
+        }
+    };
+
+    BufPool(std::size_t capacity, const std::shared_ptr<BlockArena>& arena, OnRelease onRelease):
+        m_capacity(capacity), m_arena(arena), m_onRelease(std::move(onRelease)){
+        m_free.reserve(capacity);
+    }
+
+    void recycle(Buf* buf){
+        if (m_onRelease) {
+            m_onRelease(*buf);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_free.size() < m_capacity) {
+                m_free.push_back(buf);
+                return;
+            }
+        }
+        delete buf;
+    }
+
+    const std::size_t m_capacity;
+    std::shared_ptr<BlockArena> m_arena;
+    OnRelease m_onRelease;
+    std::mutex m_mutex;
+    std::vector<Buf*> m_free;
+    std::atomic<uint64_t> m_acquired {0};
+    std::atomic<uint64_t> m_created {0};
+};
+
+template<typename Buf>
+struct BufHolder;
+
+template<typename T, typename META_T>
+struct BufHolder<hva::hvaBuf_t<T, META_T>>{
+    using type = hva::hvaBufContainerHolder_t<T, META_T>;
+};
+
+// Reusable hvaBlob_t with one buf holder per Bufs type, created once. Acquiring a blob only
+// points its holders to the given bufs, releasing it drops them, so the bufs go back to their
+// own pools as soon as no other blob holds them.
+template<typename... Bufs>
+class BlobPool : public std::enable_shared_from_this<BlobPool<Bufs...>>{
+public:
+    static std::shared_ptr<BlobPool> create(std::size_t capacity, const std::shared_ptr<BlockArena>& arena){
+        return std::shared_ptr<BlobPool>(new BlobPool(capacity, arena));
+    }
+
+    ~BlobPool(){
+        for (hva::hvaBlob_t* blob : m_free) {
+            delete blob;
+        }
+    }
+
+    std::shared_ptr<hva::hvaBlob_t> acquire(int frameId, int streamId, const std::shared_ptr<Bufs>&... bufs){
+        hva::hvaBlob_t* blob = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_free.empty()) {
+                blob = m_free.back();
+                m_free.pop_back();
+            }
+        }
+        if (!blob) {
+            m_created++;
+            blob = new hva::hvaBlob_t();
+            int pushed[] = {0, (blob->push(std::shared_ptr<Bufs>()), 0)...};
+            (void)pushed;
+        }
+        std::size_t idx = 0;
+        int assigned[] = {0, (holder<Bufs>(*blob, idx++)->m_buf = bufs, 0)...};
+        (void)assigned;
+        //--- A recycled blob must not carry fields of its previous frame
+        blob->frameId = frameId;
+        blob->streamId = streamId;
+        blob->timestamp = m_fresh.timestamp;
+        blob->typeId = m_fresh.typeId;
+        blob->ctx = m_fresh.ctx;
+        m_acquired++;
+        return std::shared_ptr<hva::hvaBlob_t>(blob, Recycler{this->shared_from_this()}, ArenaAllocator<hva::hvaBlob_t>(m_arena));
+    }
+
+    uint64_t acquired() const{
+        return m_acquired;
+    }
+
+    uint64_t created() const{
+        return m_created;
+    }
+
+private:
+    struct Recycler{
+        std::shared_ptr<BlobPool> pool;
+
+        void operator()(hva::hvaBlob_t* blob) const{
+            pool->recycle(blob);
+        }
+    };
+
+    BlobPool(std::size_t capacity, const std::shared_ptr<BlockArena>& arena): m_capacity(capacity), m_arena(arena){
+        m_free.reserve(capacity);
+        const hva::hvaBlob_t fresh;
+        m_fresh = Fields{fresh.timestamp, fresh.typeId, fresh.ctx};
+    }
+
+    template<typename Buf>
+    static typename BufHolder<Buf>::type* holder(hva::hvaBlob_t& blob, std::size_t idx){
+        return static_cast<typename BufHolder<Buf>::type*>(blob.vBuf[idx]);
+    }
+
+    void recycle(hva::hvaBlob_t* blob){
+        std::size_t idx = 0;
+        int dropped[] = {0, (holder<Bufs>(*blob, idx++)->m_buf.reset(), 0)...};
+        (void)dropped;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_free.size() < m_capacity) {
+                m_free.push_back(blob);
+                return;
+            }
+        }
+        delete blob;
+    }
+
+    // Fields of a newly constructed blob, which acquire() restores
+    struct Fields{
+        std::chrono::milliseconds timestamp;
+        int typeId;
+        int ctx;
+    };
+
+    const std::size_t m_capacity;
+    std::shared_ptr<BlockArena> m_arena;
+    Fields m_fresh;
+    std::mutex m_mutex;
+    std::vector<hva::hvaBlob_t*> m_free;
+    std::atomic<uint64_t> m_acquired {0};
+    std::atomic<uint64_t> m_created {0};
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include <ClassificationNode.hpp>
+
+#include <iomanip>
+
+#include <utils/config_factory.h>
+#include <utils/image_utils.h>
+
+ClassificationNode::ClassificationNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config):
+        hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_cfg(config){
+
+}
+
+std::shared_ptr<hva::hvaNodeWorker_t> ClassificationNode::createNodeWorker() const{
+    return std::shared_ptr<hva::hvaNodeWorker_t>(new ClassificationNodeWorker((ClassificationNode*)this, m_cfg));
+}
+
+ClassificationNodeWorker::ClassificationNodeWorker(hva::hvaNode_t* parentNode, const ClassificationNode::Config& config):hva::hvaNodeWorker_t(parentNode),
+    m_reorder(config.keepStreamOrder, [this](const std::shared_ptr<hva::hvaBlob_t>& blob) {
+            Tracer::begin("queue", blob->streamId, blob->frameId);
+            sendOutput(blob, 0, ms(0));
+        }){
+    if (config.labelFilename.empty()) {
+        throw std::invalid_argument("ClassificationNode requires a label file");
+    }
+    //--- Crops are resized by OpenCV, because ROI views are not dense and can't be wrapped into tensors
+    std::unique_ptr<ModelBase> model(new ClassificationModel(config.modelFileName, config.nTop, false,
+        ClassificationModel::loadLabels(config.labelFilename), config.layout));
+    m_pipeline = std::make_shared<AsyncPipeline>(std::move(model),
+                               ConfigFactory::getUserConfig(config.targetDevice, config.nireq, config.nstreams, config.nthreads),
+                               m_core);
+}
+
+void ClassificationNodeWorker::process(std::size_t batchIdx){
+    std::vector<std::shared_ptr<hva::hvaBlob_t>> vInput= hvaNodeWorker_t::getParentPtr()->getBatchedInput(batchIdx, std::vector<size_t> {0});
+    for (const auto& input : vInput) {
+        HVA_DEBUG("ClassificationNode received blob with frameid %u and streamid %u", input->frameId, input->streamId);
+        Tracer::end("queue", input->streamId, input->frameId);
+        TraceSpan span("ClassificationNode.submit", input->streamId, input->frameId);
+        std::shared_ptr<PendingFrame> frame = std::make_shared<PendingFrame>();
+        frame->blob = input;
+        frame->streamSeq = m_reorder.nextSeq(input->streamId);
+        frame->arrivalTime = std::chrono::steady_clock::now();
+        frame->remainingCrops = 0;
+
+        if (*input->get<int, ImageMetaData>(1)->getPtr()) {
+            m_reorder.push(input->streamId, frame->streamSeq, input);
+            continue;
+        }
+
+        auto inferMeta = input->get<int, InferMeta>(0)->getMeta();
+        const auto& objects = inferMeta->detResult.objects;
+        const cv::Mat& img = input->get<int, ImageMetaData>(1)->getMeta()->img;
+        const bool nv12 = input->get<int, ImageMetaData>(1)->getMeta()->nv12;
+        const cv::Size imgSize = nv12 ? nv12Size(img) : img.size();
+        const cv::Rect2f imgRect(0.f, 0.f, static_cast<float>(imgSize.width), static_cast<float>(imgSize.height));
+
+        std::vector<std::pair<size_t, cv::Rect>> rois;
+        for (size_t i = 0; i < objects.size(); ++i) {
+            cv::Rect roi = objects[i] & imgRect;
+            if (roi.area() > 0) {
+                rois.emplace_back(i, roi);
+            }
+        }
+        inferMeta->cntClassification = static_cast<int>(rois.size());
+        frame->remainingCrops = rois.size();
+        if (rois.empty()) {
+            completeFrame(frame);
+            continue;
+        }
+        //--- Crops of a frame run in parallel, the interval lasts until the last of them completes
+        Tracer::begin("classify", input->streamId, input->frameId);
+        for (const auto& roi : rois) {
+            //--- Only crops of NV12 frames are converted, into small BGR images of their own
+            submitCrop(nv12 ? nv12ToBGR(img, roi.second) : img(roi.second), frame, roi.first);
+        }
+    }
+}
+
+void ClassificationNodeWorker::submitCrop(const cv::Mat& crop, const std::shared_ptr<PendingFrame>& frame, size_t objectIdx){
+    {
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        while (!m_pipeline->isReadyToProcess()) {
+            m_idleCond.wait_for(lock, ms(100));
+        }
+    }
+    //--- A crop of the input size skips the resize of the model preprocessing, which only wraps dense images,
+    //--- so a crop view of the frame is copied then
+    m_pipeline->submitData(ImageInputData(crop.isContinuous() ? crop : crop.clone()),
+        std::make_shared<CropMetaData>(frame, objectIdx, std::chrono::steady_clock::now()));
+    m_cropsNum++;
+}
+
+void ClassificationNodeWorker::completeFrame(const std::shared_ptr<PendingFrame>& frame){
+    {
+        std::lock_guard<std::mutex> lock(m_metricsMutex);
+        m_frameMetrics.update(frame->arrivalTime);
+    }
+    m_reorder.push(frame->blob->streamId, frame->streamSeq, frame->blob);
+}
+
+void ClassificationNodeWorker::init(){
+}
+
+void ClassificationNodeWorker::deinit(){
+}
+
+void ClassificationNodeWorker::processByFirstRun(std::size_t batchIdx) {
+    m_resultThread = std::make_shared<std::thread> ([&]() {
+        while (m_exec) {
+            m_pipeline->waitForResult(false);
+            auto result = m_pipeline->getResult(false);
+            {
+                // Taken so a submitter checking for idle requests can't miss the notification
+                std::lock_guard<std::mutex> lock(m_idleMutex);
+            }
+            m_idleCond.notify_all();
+            if (!result) {
+                continue;
+            }
+
+            auto& cropMeta = result->metaData->asRef<CropMetaData>();
+            std::shared_ptr<PendingFrame> frame = std::move(cropMeta.frame);
+            auto inferMeta = frame->blob->get<int, InferMeta>(0)->getMeta();
+            inferMeta->detResult.objects[cropMeta.objectIdx].topLabels = result->asRef<ClassificationResult>().topLabels;
+            {
+                std::lock_guard<std::mutex> lock(m_metricsMutex);
+                m_cropMetrics.update(cropMeta.submitTime);
+                inferMeta->classificationFps = static_cast<float>(m_cropMetrics.getLast().fps);
+            }
+
+            if (--frame->remainingCrops == 0) {
+                Tracer::end("classify", frame->blob->streamId, frame->blob->frameId);
+                completeFrame(frame);
+            }
+        }
+    });
+}
+
+void ClassificationNodeWorker::processByLastRun(std::size_t batchIdx) {
+    if (m_resultThread && m_resultThread->joinable()) {
+        m_exec = false;
+        m_resultThread->join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_metricsMutex);
+    auto frames = m_frameMetrics.getTotal();
+    auto crops = m_cropMetrics.getTotal();
+    slog::info << "Classification (" << m_cropsNum << " crops)" << slog::endl;
+    slog::info << "\tFrames:\t" << std::fixed << std::setprecision(1) << frames.fps << " FPS, " << frames.latency << " ms" << slog::endl;
+    slog::info << "\tCrops:\t" << crops.fps << " FPS, " << crops.latency << " ms" << slog::endl;
+    slog::info << "\tPreprocessing:\t" << m_pipeline->getPreprocessMetrics().getTotal().latency << " ms" << slog::endl;
+    slog::info << "\tInference:\t" << m_pipeline->getInferenceMetircs().getTotal().latency << " ms" << slog::endl;
+    slog::info << "\tPostprocessing:\t" << m_pipeline->getPostprocessMetrics().getTotal().latency << " ms" << slog::endl;
+}
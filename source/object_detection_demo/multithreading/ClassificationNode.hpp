@@ -0,0 +1,102 @@
+#ifndef CLASSIFICATION_NODE_HPP
+#define CLASSIFICATION_NODE_HPP
+
+#include <thread>
+#include <iostream>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include <inc/api/hvaPipeline.hpp>
+
+#include <opencv2/core.hpp>
+
+#include <models/classification_model.h>
+#include <pipelines/async_pipeline.h>
+#include <pipelines/metadata.h>
+#include <utils/performance_metrics.hpp>
+
+#include <OdInferNode.hpp>
+#include <StreamReorder.hpp>
+#include <Tracer.hpp>
+
+using ms = std::chrono::milliseconds;
+
+// Classifies ROI of every detected object and attaches top-k labels to it.
+// ROIs are Mat views of the decoded frame, so crops are not copied before the classifier resizes them.
+// Crops of all frames and streams share one pool of infer requests, so they are classified in bursts
+// across frame and stream boundaries.
+class ClassificationNode : public hva::hvaNode_t{
+public:
+    struct Config{
+        std::string modelFileName = "";
+        std::string labelFilename = "";  //Required, classification model wrapper maps output indices to labels
+        std::string targetDevice = "CPU";
+        std::string layout = "";  //Optional. Model input layout.
+        std::size_t nTop = 1;  //Number of top labels attached to every object
+
+        uint32_t nireq = 0;  //Optional. Number of infer requests. Defines how many crops are classified at once.
+        uint32_t nthreads = 0;  //Optional. Number of threads.
+        std::string nstreams = "";  //Optional. Number of streams to use for inference on the CPU or/and GPU in throughput mode.
+
+        bool keepStreamOrder = true;  //Emit frames of each stream in order, see ODInferNode::Config::keepStreamOrder
+    };
+
+    ClassificationNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config);
+
+    virtual std::shared_ptr<hva::hvaNodeWorker_t> createNodeWorker() const override;
+
+private:
+    Config m_cfg;
+};
+
+class ClassificationNodeWorker : public hva::hvaNodeWorker_t{
+public:
+    ClassificationNodeWorker(hva::hvaNode_t* parentNode, const ClassificationNode::Config& config);
+
+    virtual void process(std::size_t batchIdx) override;
+    virtual void init() override;
+    virtual void deinit() override;
+
+    virtual void processByFirstRun(std::size_t batchIdx) override;
+    virtual void processByLastRun(std::size_t batchIdx) override;
+
+private:
+    // Frame waiting for classification of its objects
+    struct PendingFrame{
+        std::shared_ptr<hva::hvaBlob_t> blob;
+        uint64_t streamSeq;
+        std::chrono::steady_clock::time_point arrivalTime;
+        std::atomic<size_t> remainingCrops;
+    };
+
+    // Carries the frame and the object index of a crop through AsyncPipeline
+    struct CropMetaData : public MetaData{
+        std::shared_ptr<PendingFrame> frame;
+        size_t objectIdx;
+        std::chrono::steady_clock::time_point submitTime;
+
+        CropMetaData(const std::shared_ptr<PendingFrame>& frame, size_t objectIdx, std::chrono::steady_clock::time_point submitTime):
+            frame(frame), objectIdx(objectIdx), submitTime(submitTime){}
+    };
+
+    void submitCrop(const cv::Mat& crop, const std::shared_ptr<PendingFrame>& frame, size_t objectIdx);
+    void completeFrame(const std::shared_ptr<PendingFrame>& frame);
+
+    std::shared_ptr<AsyncPipeline> m_pipeline;
+    ov::Core m_core;
+
+    std::shared_ptr<std::thread> m_resultThread;
+    std::atomic_bool m_exec {true};
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCond;  //Signaled by the result thread when a request becomes idle
+
+    StreamReorder m_reorder;
+
+    uint64_t m_cropsNum = 0;
+    std::mutex m_metricsMutex;  //Frames without objects complete on the process thread, others on the result thread
+    PerformanceMetrics m_frameMetrics;  //From frame arrival to classification of all its objects
+    PerformanceMetrics m_cropMetrics;  //From crop submission to its result, updated by the result thread
+};
+#endif
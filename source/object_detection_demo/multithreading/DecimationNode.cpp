@@ -0,0 +1,110 @@
+#include <DecimationNode.hpp>
+
+#include <algorithm>
+#include <iomanip>
+
+DecimationNode::DecimationNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config):
+        hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_cfg(config){
+    if (!m_cfg.monitor) {
+        throw std::invalid_argument("DecimationNode requires a latency monitor updated by the sink");
+    }
+    if (m_cfg.minKeepRatio <= 0.0 || m_cfg.minKeepRatio > 1.0) {
+        throw std::invalid_argument("DecimationNode minimal keep ratio should be in (0, 1]");
+    }
+}
+
+std::shared_ptr<hva::hvaNodeWorker_t> DecimationNode::createNodeWorker() const{
+    return std::shared_ptr<hva::hvaNodeWorker_t>(new DecimationNodeWorker((DecimationNode*)this, m_cfg));
+}
+
+DecimationNodeWorker::DecimationNodeWorker(hva::hvaNode_t* parentNode, const DecimationNode::Config& config):hva::hvaNodeWorker_t(parentNode),
+        m_cfg(config){
+
+}
+
+void DecimationNodeWorker::process(std::size_t batchIdx){
+    std::vector<std::shared_ptr<hva::hvaBlob_t>> vInput= hvaNodeWorker_t::getParentPtr()->getBatchedInput(batchIdx, std::vector<size_t> {0});
+    for (const auto& input : vInput) {
+        HVA_DEBUG("DecimationNode received blob with frameid %u and streamid %u", input->frameId, input->streamId);
+        Tracer::end("queue", input->streamId, input->frameId);
+
+        if (*input->get<int, ImageMetaData>(0)->getPtr()) {
+            //--- EOF blob is never dropped
+            Tracer::begin("queue", input->streamId, input->frameId);
+            sendOutput(input, 0, ms(0));
+            continue;
+        }
+        control();
+        m_periodArrivals++;
+
+        auto& stream = m_streams[input->streamId];
+        stream.received++;
+        stream.credit += m_keepRatio;
+        if (stream.credit < 1.0) {
+            //--- Released blob returns its credit to FrameReaderNode, which reads the next frame right away
+            stream.decimated++;
+            continue;
+        }
+        stream.credit -= 1.0;
+        Tracer::begin("queue", input->streamId, input->frameId);
+        if (sendOutput(input, 0, m_cfg.sendTimeout) == hva::hvaSuccess) {
+            stream.kept++;
+        } else {
+            //--- Dropped frame never reaches the next node, so its queue interval ends here
+            Tracer::end("queue", input->streamId, input->frameId);
+            stream.portFull++;
+        }
+    }
+}
+
+void DecimationNodeWorker::control(){
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> elapsed = now - m_periodStart;
+    if (elapsed < m_cfg.controlPeriod) {
+        return;
+    }
+    const double arrivalRate = m_periodArrivals / elapsed.count();
+    m_periodArrivals = 0;
+    m_periodStart = now;
+
+    const auto feedback = m_cfg.monitor->snapshot();
+    if (feedback.completed == 0) {
+        return;
+    }
+    if (feedback.latencyMs > m_cfg.targetLatencyMs) {
+        //--- Keeping what the pipeline serves stops the growth, keeping less drains the queues built so far
+        double ratio = m_keepRatio * 0.9;
+        if (feedback.serviceRate > 0.0 && arrivalRate > 0.0) {
+            ratio = std::min(ratio, 0.9 * feedback.serviceRate / arrivalRate);
+        }
+        m_keepRatio = ratio;
+    } else if (feedback.latencyMs < m_cfg.lowWatermark * m_cfg.targetLatencyMs) {
+        m_keepRatio += m_cfg.increaseStep;
+    }
+    m_keepRatio = std::min(1.0, std::max(m_cfg.minKeepRatio, m_keepRatio));
+    m_minKeepRatioSeen = std::min(m_minKeepRatioSeen, m_keepRatio);
+    HVA_DEBUG("DecimationNode latency %.1f ms, service %.1f FPS, arrival %.1f FPS, keep ratio %.2f",
+        feedback.latencyMs, feedback.serviceRate, arrivalRate, m_keepRatio);
+}
+
+void DecimationNodeWorker::init(){
+}
+
+void DecimationNodeWorker::deinit(){
+}
+
+void DecimationNodeWorker::processByFirstRun(std::size_t batchIdx) {
+    m_periodStart = std::chrono::steady_clock::now();
+}
+
+void DecimationNodeWorker::processByLastRun(std::size_t batchIdx) {
+    slog::info << "Decimation (target latency " << std::fixed << std::setprecision(1) << m_cfg.targetLatencyMs << " ms)" << slog::endl;
+    slog::info << "\tKeep ratio:\t" << std::setprecision(2) << m_keepRatio << " last, " << m_minKeepRatioSeen << " min" << slog::endl;
+    for (const auto& stream : m_streams) {
+        const auto& stats = stream.second;
+        const uint64_t dropped = stats.decimated + stats.portFull;
+        slog::info << "\tStream #" << stream.first << ":\t" << stats.kept << " of " << stats.received << " kept, " <<
+            std::setprecision(1) << (stats.received ? 100.0 * dropped / stats.received : 0.0) << "% dropped (" <<
+            stats.portFull << " on full port)" << slog::endl;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef DECIMATION_NODE_HPP
+#define DECIMATION_NODE_HPP
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+
+#include <inc/api/hvaPipeline.hpp>
+
+#include <pipelines/metadata.h>
+
+#include <LatencyMonitor.hpp>
+#include <Tracer.hpp>
+
+using ms = std::chrono::milliseconds;
+
+// Drops frames before inference when the pipeline can't keep up, to hold a target end-to-end latency.
+// The share of frames kept follows the measured service rate: it is cut when latency reported by the
+// sink exceeds the target and raised step by step once latency is well below it. Every stream keeps
+// the same share, spread evenly over its frames. Frames the next node can't take within sendTimeout
+// are dropped too, so the queue in front of inference never grows to the HVA port limit.
+class DecimationNode : public hva::hvaNode_t{
+public:
+    struct Config{
+        std::shared_ptr<LatencyMonitor> monitor = nullptr;  //Required, updated by the sink with every completed frame
+        double targetLatencyMs = 200.0;  //End-to-end latency to hold, from frame read to the sink
+        double minKeepRatio = 0.05;  //Share of frames kept under the heaviest overload
+        double increaseStep = 0.05;  //Keep ratio added per control period while latency is below lowWatermark * targetLatencyMs
+        double lowWatermark = 0.8;
+        ms controlPeriod = ms(200);  //How often the keep ratio is updated
+        ms sendTimeout = ms(10);  //Frame is dropped if the port of the next node stays full this long
+    };
+
+    DecimationNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config);
+
+    virtual std::shared_ptr<hva::hvaNodeWorker_t> createNodeWorker() const override;
+
+private:
+    Config m_cfg;
+};
+
+class DecimationNodeWorker : public hva::hvaNodeWorker_t{
+public:
+    DecimationNodeWorker(hva::hvaNode_t* parentNode, const DecimationNode::Config& config);
+
+    virtual void process(std::size_t batchIdx) override;
+    virtual void init() override;
+    virtual void deinit() override;
+
+    virtual void processByFirstRun(std::size_t batchIdx) override;
+    virtual void processByLastRun(std::size_t batchIdx) override;
+
+private:
+    struct StreamStats{
+        double credit = 0.0;  //Accumulated keep ratio, a frame is kept each time it reaches 1
+        uint64_t received = 0;
+        uint64_t kept = 0;
+        uint64_t decimated = 0;  //Dropped to follow the keep ratio
+        uint64_t portFull = 0;  //Dropped because the next node didn't take them in time
+    };
+
+    void control();
+
+    DecimationNode::Config m_cfg;
+    std::map<int, StreamStats> m_streams;
+
+    double m_keepRatio = 1.0;
+    double m_minKeepRatioSeen = 1.0;
+    uint64_t m_periodArrivals = 0;
+    std::chrono::steady_clock::time_point m_periodStart;
+};
+#endif
@@ -0,0 +1,86 @@
+#ifndef DETECTION_SCHEDULER_HPP
+#define DETECTION_SCHEDULER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+// Decides per stream which frames go through detection. ODInferNode asks it for every frame
+// and TrackerNode, which propagates tracks over skipped frames, adapts the interval.
+class DetectionScheduler{
+public:
+    // Interval is the number of frames per detected frame: 1 detects every frame.
+    // minInterval == maxInterval gives a fixed interval, otherwise it starts at minInterval and is adapted.
+    DetectionScheduler(unsigned minInterval, unsigned maxInterval):
+        m_minInterval(std::max(1u, minInterval)), m_maxInterval(std::max(m_minInterval, maxInterval)){}
+
+    bool shouldDetect(int streamId){
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& stream = getStream(streamId);
+        if (++stream.sinceDetection >= stream.interval) {
+            stream.sinceDetection = 0;
+            stream.detected++;
+            return true;
+        }
+        stream.skipped++;
+        return false;
+    }
+
+    void setInterval(int streamId, unsigned interval){
+        std::lock_guard<std::mutex> lock(m_mutex);
+        getStream(streamId).interval = std::min(m_maxInterval, std::max(m_minInterval, interval));
+    }
+
+    unsigned interval(int streamId){
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return getStream(streamId).interval;
+    }
+
+    bool isAdaptive() const{
+        return m_minInterval != m_maxInterval;
+    }
+
+    unsigned minInterval() const{
+        return m_minInterval;
+    }
+
+    unsigned maxInterval() const{
+        return m_maxInterval;
+    }
+
+    struct Counters{
+        uint64_t detected;
+        uint64_t skipped;
+    };
+
+    Counters counters(int streamId){
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto& stream = getStream(streamId);
+        return {stream.detected, stream.skipped};
+    }
+
+private:
+    struct Stream{
+        unsigned interval;
+        unsigned sinceDetection;
+        uint64_t detected;
+        uint64_t skipped;
+    };
+
+    Stream& getStream(int streamId){
+        auto it = m_streams.find(streamId);
+        if (it == m_streams.end()) {
+            // First frame of a stream is always detected
+            it = m_streams.emplace(streamId, Stream{m_minInterval, m_minInterval - 1, 0, 0}).first;
+        }
+        return it->second;
+    }
+
+    const unsigned m_minInterval;
+    const unsigned m_maxInterval;
+    std::mutex m_mutex;
+    std::map<int, Stream> m_streams;
+};
+
+#endif
@@ -1,16 +1,20 @@
 #include <DisplayNode.hpp>
 
+#include <utils/image_utils.h>
+
 DisplayNode::DisplayNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config):
-        hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_reserved1(config.reserved1), m_reserved2(config.reserved2){
+        hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_reserved1(config.reserved1), m_reserved2(config.reserved2),
+        m_latencyMonitor(config.latencyMonitor){
 
 }
 
 std::shared_ptr<hva::hvaNodeWorker_t> DisplayNode::createNodeWorker() const{
-    return std::shared_ptr<hva::hvaNodeWorker_t>(new DisplayNodeWorker((DisplayNode*)this, m_reserved1, m_reserved2));
+    return std::shared_ptr<hva::hvaNodeWorker_t>(new DisplayNodeWorker((DisplayNode*)this, m_reserved1, m_reserved2, m_latencyMonitor));
 }
 
-DisplayNodeWorker::DisplayNodeWorker(hva::hvaNode_t* parentNode, unsigned reserved1, unsigned reserved2):hva::hvaNodeWorker_t(parentNode), 
-        m_reserved1(reserved1), m_reserved2(reserved2){
+DisplayNodeWorker::DisplayNodeWorker(hva::hvaNode_t* parentNode, unsigned reserved1, unsigned reserved2,
+        const std::shared_ptr<LatencyMonitor>& latencyMonitor):hva::hvaNodeWorker_t(parentNode), 
+        m_reserved1(reserved1), m_reserved2(reserved2), m_latencyMonitor(latencyMonitor){
 
 }
 
@@ -19,7 +23,9 @@ cv::Mat DisplayNodeWorker::renderDetectionData(DetectionResult& result, const Co
         throw std::invalid_argument("Renderer: metadata is null");
     }
 
-    auto outputImg = result.metaData->asRef<ImageMetaData>().img;
+    //Frames may be shared by loops of a cached input, so detections are drawn on a copy. NV12 frames are converted only here, when rendered
+    const auto& frame = result.metaData->asRef<ImageMetaData>();
+    auto outputImg = frame.nv12 ? nv12ToBGR(frame.img) : frame.img.clone();
 
     if (outputImg.empty()) {
         throw std::invalid_argument("Renderer: image provided in metadata is empty");
@@ -31,8 +37,10 @@ cv::Mat DisplayNodeWorker::renderDetectionData(DetectionResult& result, const Co
         std::ostringstream conf;
         conf << ":" << std::fixed << std::setprecision(1) << obj.confidence * 100 << '%';
         const auto& color = palette[obj.labelID];
+        //Top classification label, if the object was classified, replaces the detector label
+        const std::string& label = obj.topLabels.empty() ? obj.label : obj.topLabels.front().label;
         putHighlightedText(outputImg,
-                           obj.label + conf.str(),
+                           label + conf.str(),
                            cv::Point2f(obj.x, obj.y - 5),
                            cv::FONT_HERSHEY_COMPLEX_SMALL,
                            1,
@@ -55,6 +63,8 @@ void DisplayNodeWorker::process(std::size_t batchIdx){
     std::vector<std::shared_ptr<hva::hvaBlob_t>> vInput= hvaNodeWorker_t::getParentPtr()->getBatchedInput(batchIdx, std::vector<size_t> {0});
     if(vInput.size() != 0){
         HVA_DEBUG("DispalyNode received blob with frameid %u and streamid %u", vInput[0]->frameId, vInput[0]->streamId);
+        Tracer::end("queue", vInput[0]->streamId, vInput[0]->frameId);
+        TraceSpan span("DisplayNode", vInput[0]->streamId, vInput[0]->frameId);
 
         auto eof = vInput[0]->get<int, ImageMetaData>(1)->getPtr();
         if (!(*eof)) {
@@ -66,13 +76,19 @@ void DisplayNodeWorker::process(std::size_t batchIdx){
 
             auto ptrInferMeta = vInput[0]->get<int, InferMeta>(0)->getMeta();
             cv::Mat outFrame = renderDetectionData(ptrInferMeta->detResult, *m_palettePtr.get(), *m_outputTransform.get());
-            m_metrics->update(timeStamp,
+            m_metrics[vInput[0]->streamId].update(timeStamp,
                                outFrame,
                                {10, 22},
                                cv::FONT_HERSHEY_COMPLEX,
                                0.65);
-            cv::imshow("Detection Results", outFrame);
-            cv::waitKey(1);
+            if (m_latencyMonitor) {
+                m_latencyMonitor->update(timeStamp);
+            }
+            cv::imshow("Detection Results #" + std::to_string(vInput[0]->streamId), outFrame);
+            int key = cv::waitKey(1);
+            if ((key == 't' || key == 'T') && Tracer::enabled()) {
+                slog::info << "Trace of " << Tracer::dump() << " events is written" << slog::endl;
+            }
         }
     }
 }
@@ -86,7 +102,6 @@ void DisplayNodeWorker::deinit(){
 void DisplayNodeWorker::processByFirstRun(std::size_t batchIdx) {
     m_palettePtr.reset(new ColorPalette(100));
     m_outputTransform.reset(new OutputTransform());
-    m_metrics.reset(new PerformanceMetrics());
 }
 
 void DisplayNodeWorker::processByLastRun(std::size_t batchIdx) {
@@ -4,6 +4,7 @@
 #include <thread>
 #include <iostream>
 #include <atomic>
+#include <map>
 #include <random>
 
 #include <inc/api/hvaPipeline.hpp>
@@ -15,7 +16,9 @@
 
 #include <utils/ocv_common.hpp>
 
+#include <LatencyMonitor.hpp>
 #include <OdInferNode.hpp>
+#include <Tracer.hpp>
 
 using ms = std::chrono::milliseconds;
 
@@ -95,6 +98,7 @@ public:
     struct Config{
         unsigned reserved1;
         unsigned reserved2;
+        std::shared_ptr<LatencyMonitor> latencyMonitor = nullptr;  //Optional, told of every displayed frame
     };
 
     DisplayNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config);
@@ -104,11 +108,12 @@ public:
 private:
     unsigned m_reserved1;
     unsigned m_reserved2;
+    std::shared_ptr<LatencyMonitor> m_latencyMonitor;
 };
 
 class DisplayNodeWorker : public hva::hvaNodeWorker_t{
 public:
-    DisplayNodeWorker(hva::hvaNode_t* parentNode, unsigned reserved1, unsigned reserved2);
+    DisplayNodeWorker(hva::hvaNode_t* parentNode, unsigned reserved1, unsigned reserved2, const std::shared_ptr<LatencyMonitor>& latencyMonitor);
 
     virtual void process(std::size_t batchIdx) override;
     virtual void init() override;
@@ -117,15 +122,17 @@ public:
     virtual void processByFirstRun(std::size_t batchIdx) override;
     virtual void processByLastRun(std::size_t batchIdx) override;
 
+    // Draws detections over the frame stored in result metadata and returns it
+    static cv::Mat renderDetectionData(DetectionResult& result, const ColorPalette& palette, OutputTransform& outputTransform);
+
 private:
     unsigned m_reserved1;
     unsigned m_reserved2;
+    std::shared_ptr<LatencyMonitor> m_latencyMonitor;
 
     cv::Mat curr_frame;
     std::shared_ptr<ColorPalette> m_palettePtr;
     std::shared_ptr<OutputTransform> m_outputTransform;
-    std::shared_ptr<PerformanceMetrics> m_metrics;
-
-    cv::Mat renderDetectionData(DetectionResult& result, const ColorPalette& palette, OutputTransform& outputTransform);
+    std::map<unsigned, PerformanceMetrics> m_metrics;  //Per stream metrics, keyed by streamId
 };
 #endif
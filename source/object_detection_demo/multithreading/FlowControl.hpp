@@ -0,0 +1,59 @@
+#ifndef FLOW_CONTROL_HPP
+#define FLOW_CONTROL_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// Credit based flow control of one stream. The reader takes a credit before it decodes
+// a frame and the blob deleter gives it back, waking the reader as soon as capacity frees up.
+class FlowControl{
+public:
+    explicit FlowControl(unsigned maxDepth): m_maxDepth(maxDepth), m_depth(0), m_peakDepth(0){}
+
+    // Waits for a free credit up to timeout. Returns false if no credit was released in time,
+    // so the caller can give control back to the framework (e.g. to let the pipeline stop).
+    template <typename Rep, typename Period>
+    bool acquire(const std::chrono::duration<Rep, Period>& timeout){
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cond.wait_for(lock, timeout, [this] { return m_depth < m_maxDepth; })) {
+            return false;
+        }
+        m_depth++;
+        m_peakDepth = std::max(m_peakDepth, m_depth);
+        return true;
+    }
+
+    void release(){
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_depth--;
+        }
+        m_cond.notify_one();
+    }
+
+    unsigned depth() const{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_depth;
+    }
+
+    // Highest number of credits taken at once
+    unsigned peakDepth() const{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_peakDepth;
+    }
+
+    unsigned maxDepth() const{
+        return m_maxDepth;
+    }
+
+private:
+    const unsigned m_maxDepth;
+    unsigned m_depth;
+    unsigned m_peakDepth;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+#endif
@@ -1,75 +1,110 @@
 #include <FrameReaderNode.hpp>
-#include <pipelines/metadata.h>
-
-#include <windows.h>
+#include <AllocationCounter.hpp>
 
 FrameReaderNode::FrameReaderNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config):
-        m_workerIdx(0), hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_cfg(config){
-
+        m_workerIdx(0), m_endedStreams(0), hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_cfg(config){
+    if (m_cfg.inputs.size() != totalThreadNum) {
+        throw std::invalid_argument("FrameReaderNode expects one worker per input, got " + std::to_string(m_cfg.inputs.size()) +
+            " inputs and " + std::to_string(totalThreadNum) + " workers");
+    }
+    if (!m_cfg.segments.empty() && m_cfg.segments.size() != m_cfg.inputs.size()) {
+        throw std::invalid_argument("FrameReaderNode expects one segment per input, got " + std::to_string(m_cfg.segments.size()) +
+            " segments and " + std::to_string(m_cfg.inputs.size()) + " inputs");
+    }
 }
 
 std::shared_ptr<hva::hvaNodeWorker_t> FrameReaderNode::createNodeWorker() const{
     unsigned workerIdx = m_workerIdx.fetch_add(1);
+    if (workerIdx >= m_cfg.inputs.size()) {
+        throw std::out_of_range("FrameReaderNode has no input for worker " + std::to_string(workerIdx));
+    }
     return std::shared_ptr<hva::hvaNodeWorker_t>(new FrameReaderNodeWorker((FrameReaderNode*)this, static_cast<int>(workerIdx), m_cfg));
 }
 
+void FrameReaderNode::onStreamEnd(){
+    if (m_endedStreams.fetch_add(1) + 1 == m_cfg.inputs.size()) {
+        emitEvent(hvaEvent_EOF, nullptr);
+        HVA_WARNING("Emit hvaEvent_EOF!");
+    }
+}
+
 FrameReaderNodeWorker::FrameReaderNodeWorker(hva::hvaNode_t* parentNode, int streamId, const FrameReaderNode::Config& config):hva::hvaNodeWorker_t(parentNode),
     m_streamId(streamId){
-    m_input = config.input;
+    m_input = config.inputs[streamId];
     m_loop = config.infiniteLoop;
     m_rt = config.readType;
+    m_prefetchDepth = config.prefetchDepth;
+    m_cacheLimitMb = config.cacheLimitMb;
+    m_decodeSize = config.decodeSize;
+    m_nv12 = config.nv12;
+    m_segment = config.segments.empty() ? VideoSegment{0, std::numeric_limits<size_t>::max()} : config.segments[streamId];
+    m_credits = std::make_shared<FlowControl>(config.maxDepth);
+    //--- At most maxDepth frames of the stream are in flight, plus frames decoded ahead and the one being decoded,
+    //--- so safe reads never allocate once the pool is warm
+    m_framePool = std::make_shared<FrameBufferPool>(config.maxDepth + (m_rt == read_type::prefetch ? m_prefetchDepth + 1 : 0));
+    //--- A released buf returns a credit before it is back in its pool, so one more buf may exist for a moment
+    std::shared_ptr<FlowControl> credits = m_credits;
+    FrameReaderNode* frNode = dynamic_cast<FrameReaderNode*>(parentNode);
+    m_arena = std::make_shared<BlockArena>(config.maxDepth + 1);
+    m_bufPool = BufPool<int, ImageMetaData>::create(config.maxDepth + 1, m_arena, [credits, frNode](FrameBuf& buf) {
+            buf.getMeta()->img.release();
+            if (*buf.getPtr()) {
+                frNode->onStreamEnd();
+            }
+            credits->release();
+        });
+    m_blobPool = BlobPool<FrameBuf>::create(config.maxDepth + 1, m_arena);
     HVA_DEBUG("FrameReaderNodeWorker[%d] input %s\n", m_streamId, m_input.c_str());
 
 }
 
 void FrameReaderNodeWorker::process(std::size_t batchIdx){
-    while (1) {
-        if (m_currDepth >= m_maxDepth)
-            Sleep(5);
-        else
-            break;
+    if (m_ended) {
+        //--- Stream has sent its EOF blob, other streams may be still running
+        std::this_thread::sleep_for(ms(100));
+        return;
+    }
+    //--- Waiting until downstream nodes release a frame of this stream
+    if (!m_credits->acquire(ms(100))) {
+        return;
     }
+    m_depthSum += m_credits->depth();
     //--- Capturing frame
+    TraceSpan span("FrameReaderNode", m_streamId, m_frame_index);
     auto startTime = std::chrono::steady_clock::now();
     cv::Mat curr_frame = m_cap->read();
 
     bool pipe_stop_event = false;
-    FrameReaderNode  * m_FRNode = dynamic_cast<FrameReaderNode*>(hva::hvaNodeWorker_t::getParentPtr());
 
     if (curr_frame.empty()) {
         if (!m_loop) {
             //Should handle this case
-            HVA_WARNING("EOF!");
+            HVA_WARNING("Stream %d EOF!", m_streamId);
             pipe_stop_event = true;
+            m_ended = true;
         } else {
-            m_cap = openImagesCapture(m_input, m_loop, m_rt);
+            m_cap = openImagesCapture(m_input, m_loop, m_rt, m_segment.firstFrame, m_segment.frameNum, {1280, 720}, m_prefetchDepth, 0, m_decodeSize, m_nv12);
+            m_cap->setFramePool(m_framePool);
+            m_credits->release();
             return;
         }
     }
-    auto outputResolution = curr_frame.size();
 
-    std::shared_ptr<hva::hvaBlob_t> blob(new hva::hvaBlob_t());
-
-    int *eof;
-    if (pipe_stop_event)
-        eof = new int(1);
-    else
-        eof = new int(0);
-
-    blob->emplace<int, ImageMetaData>(eof, 8u, new ImageMetaData{curr_frame, startTime},
-            [this, pipe_stop_event, m_FRNode](int * m, ImageMetaData * m_meta) {
-                if(pipe_stop_event) {
-                    m_FRNode->emitEvent(hvaEvent_EOF, nullptr);
-                    HVA_WARNING("Emit hvaEvent_EOF!");
-                }
-                delete m;
-                delete m_meta;
-                this->m_currDepth --;
-            });
-    blob->frameId = m_frame_index;
-    blob->streamId = m_streamId;
+    //--- Blob, buf, EOF flag and metadata are reused, releasing the buf returns the credit
+    uint64_t allocationsBefore = threadAllocationCount();
+    std::shared_ptr<FrameBuf> buf = m_bufPool->acquire();
+    *buf->getPtr() = pipe_stop_event ? 1 : 0;
+    buf->getMeta()->img = curr_frame;
+    buf->getMeta()->timeStamp = startTime;
+    buf->getMeta()->sourceScale = m_cap->getSourceScale();
+    buf->getMeta()->nv12 = m_nv12;
+    std::shared_ptr<hva::hvaBlob_t> blob = m_blobPool->acquire(m_frame_index, m_streamId, buf);
+    m_blobAllocations += threadAllocationCount() - allocationsBefore;
     m_frame_index ++;
-    m_currDepth ++;
+    if (!pipe_stop_event) {
+        m_admissionMetrics.update(startTime);
+    }
+    Tracer::begin("queue", blob->streamId, blob->frameId);
     sendOutput(blob, 0, ms(0));
 }
 
@@ -80,11 +115,45 @@ void FrameReaderNodeWorker::deinit(){
 }
 
 void FrameReaderNodeWorker::processByFirstRun(std::size_t batchIdx) {
-    m_cap = openImagesCapture(m_input, m_loop, m_rt);
+    if (m_cacheLimitMb > 0) {
+        //--- Loops over the cached input never end, so the capture is not reopened
+        m_cap = openCachedCapture(m_input, m_loop, m_cacheLimitMb << 20, m_segment.firstFrame, m_segment.frameNum, m_decodeSize, m_nv12);
+    } else {
+        m_cap = openImagesCapture(m_input, m_loop, m_rt, m_segment.firstFrame, m_segment.frameNum, {1280, 720}, m_prefetchDepth, 0, m_decodeSize, m_nv12);
+    }
+    m_cap->setFramePool(m_framePool);
 }
 
 void FrameReaderNodeWorker::processByLastRun(std::size_t batchIdx) {
     auto readLat = m_cap->getMetrics().getTotal().latency;
+    auto admission = m_admissionMetrics.getTotal();
+    double avgDepth = m_frame_index > 0 ? static_cast<double>(m_depthSum) / m_frame_index : 0.0;
+    slog::info << "Stream #" << m_streamId << " (" << m_input << ")" << slog::endl;
     slog::info << "\tDecoding:\t" << std::fixed << std::setprecision(1) <<
         readLat << " ms" << slog::endl;
+    slog::info << "\tDecoding FPS:\t" << (readLat > 0 ? 1000.0 / readLat : 0.0) << slog::endl;
+    slog::info << "\tDelivered FPS:\t" << admission.fps << slog::endl;
+    if (m_cap->getSourceScale() > 1.0) {
+        slog::info << "\tReduced decoding:\t" << m_cap->getSourceScale() << "x smaller frames" << slog::endl;
+    }
+    slog::info << "\tQueue depth:\t" << avgDepth << " avg, " << m_credits->peakDepth() << " peak, " <<
+        m_credits->maxDepth() << " max" << slog::endl;
+    PrefetchStats stats;
+    if (m_cap->getPrefetchStats(stats)) {
+        slog::info << "\tRead ahead:\t" << stats.decodeMs << " ms decoding, " << stats.consumerStalls << " waits for decoding (" <<
+            stats.consumerStallMs << " ms), " << stats.decoderStalls << " waits for room ahead (" << stats.decoderStallMs << " ms)" << slog::endl;
+    }
+    if (CachedCapture* cached = dynamic_cast<CachedCapture*>(m_cap.get())) {
+        auto cache = cached->getStats();
+        slog::info << "\tFrame cache:\t" << (cache.streaming ? "input exceeds the limit, decoded on every loop" :
+            std::to_string(cache.frames) + " frames, " + std::to_string(cache.bytes >> 20) + " MB") <<
+            ", " << cache.loops << " loops" << slog::endl;
+    }
+    if (m_rt != read_type::efficient || m_cacheLimitMb > 0) {
+        auto pool = m_framePool->getStats();
+        slog::info << "\tFrame pool:\t" << pool.hitRate() * 100 << "% hits, " << pool.highWaterMark << " peak in use, " <<
+            pool.buffers << " of " << m_framePool->capacity() << " buffers" << slog::endl;
+    }
+    slog::info << "\tBlob building allocations:\t" << m_blobAllocations << " total, " <<
+        (m_frame_index > 0 ? static_cast<double>(m_blobAllocations) / m_frame_index : 0.0) << " per frame" << slog::endl;
 }
@@ -4,6 +4,9 @@
 #include <thread>
 #include <iostream>
 #include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <inc/api/hvaPipeline.hpp>
 // #include <inc/api/hvaBlob.hpp>
@@ -12,7 +15,14 @@
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <pipelines/metadata.h>
+#include <utils/frame_buffer_pool.hpp>
 #include <utils/images_capture.h>
+#include <utils/performance_metrics.hpp>
+
+#include <BlobPool.hpp>
+#include <FlowControl.hpp>
+#include <Tracer.hpp>
 
 using ms = std::chrono::milliseconds;
 
@@ -21,18 +31,28 @@ using ms = std::chrono::milliseconds;
 class FrameReaderNode : public hva::hvaNode_t{
 public:
     struct Config{
-        std::string input;
+        std::vector<std::string> inputs;  //One stream per input, decoded by its own worker with streamId equal to the input index
+        std::vector<VideoSegment> segments;  //Optional. Frames read from the input of the same index, e.g. segments of one video from splitVideo()
         bool infiniteLoop;
-        read_type readType;  //read_type::efficient or read_type::safe
+        read_type readType;  //read_type::efficient, read_type::safe or read_type::prefetch to decode ahead on separate threads
+        std::size_t prefetchDepth = 4;  //Frames decoded ahead with read_type::prefetch
+        unsigned maxDepth = 16;  //Maximum number of frames of each stream in flight in the pipeline
+        cv::Size decodeSize;  //Smallest frame size needed, usually the network input. Larger inputs are decoded reduced by 2, 4 or 8. Empty decodes full size
+        bool nv12 = false;  //Frames are NV12, left as decoded where the backend can, see openImagesCapture. Needs ODInferNode::Config::nv12Input
+        std::size_t cacheLimitMb = 0;  //Frames of the first pass are kept in memory and looped without decoding, if they fit. 0 disables the cache
     };
 
     FrameReaderNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config);
 
     virtual std::shared_ptr<hva::hvaNodeWorker_t> createNodeWorker() const override;
 
+    // Called when the last blob of a stream is released. hvaEvent_EOF is emitted once all streams ended
+    void onStreamEnd();
+
 private:
     Config m_cfg;
     mutable std::atomic<unsigned> m_workerIdx;
+    std::atomic<unsigned> m_endedStreams;
 };
 
 class FrameReaderNodeWorker : public hva::hvaNodeWorker_t{
@@ -56,14 +76,28 @@ public:
 private:
     int m_streamId;
     int m_frame_index = 0;
+    bool m_ended = false;
 
     std::string m_input;
     bool m_loop;
-    read_type m_rt;  //read_type::efficient or read_type::safe
+    read_type m_rt;  //read_type::efficient, read_type::safe or read_type::prefetch
+    std::size_t m_prefetchDepth;
+    std::size_t m_cacheLimitMb;
+    cv::Size m_decodeSize;
+    bool m_nv12;
+    VideoSegment m_segment;  //The whole input unless segments are set
 
     std::unique_ptr<ImagesCapture> m_cap;
+    PerformanceMetrics m_admissionMetrics;  //Rate of frames sent downstream, including waits for credits
+    uint64_t m_depthSum = 0;  //Sum of stream depths seen at admission, for the average queue depth
+
+    std::shared_ptr<FlowControl> m_credits;  //Shared with blob deleters, which may outlive the worker
+    std::shared_ptr<FrameBufferPool> m_framePool;  //Buffers of safe reads, kept across reopening of the input to loop
 
-    std::atomic_uint m_currDepth = 0;
-    unsigned int m_maxDepth =16;
+    using FrameBuf = hva::hvaBuf_t<int, ImageMetaData>;  //EOF flag and the frame
+    std::shared_ptr<BlockArena> m_arena;  //Control blocks of pooled blobs and bufs
+    std::shared_ptr<BufPool<int, ImageMetaData>> m_bufPool;  //Shared with buf deleters, which may outlive the worker
+    std::shared_ptr<BlobPool<FrameBuf>> m_blobPool;
+    uint64_t m_blobAllocations = 0;  //Heap allocations made by this thread to build blobs, decoding is not counted
 };
 #endif
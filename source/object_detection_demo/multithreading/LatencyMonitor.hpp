@@ -0,0 +1,55 @@
+#ifndef LATENCY_MONITOR_HPP
+#define LATENCY_MONITOR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Feedback from the end of the pipeline to nodes upstream. The sink reports every frame it
+// completes, DecimationNode reads the smoothed end-to-end latency and the service rate.
+class LatencyMonitor{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Snapshot{
+        double latencyMs;  //Smoothed latency from frame read to its completion, 0 before the first frame
+        double serviceRate;  //Frames completed per second over the last measurement window
+        uint64_t completed;
+    };
+
+    // smoothing is the weight of the newest latency sample
+    explicit LatencyMonitor(double smoothing = 0.1, Clock::duration window = std::chrono::milliseconds(500)):
+        m_smoothing(smoothing), m_window(window), m_latencyMs(0.0), m_serviceRate(0.0), m_completed(0),
+        m_windowCompleted(0), m_windowStart(Clock::now()){}
+
+    void update(Clock::time_point frameTimeStamp){
+        const auto now = Clock::now();
+        const double latencyMs = std::chrono::duration<double, std::milli>(now - frameTimeStamp).count();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latencyMs = m_completed ? m_latencyMs + m_smoothing * (latencyMs - m_latencyMs) : latencyMs;
+        m_completed++;
+        m_windowCompleted++;
+        if (now - m_windowStart >= m_window) {
+            m_serviceRate = m_windowCompleted / std::chrono::duration<double>(now - m_windowStart).count();
+            m_windowCompleted = 0;
+            m_windowStart = now;
+        }
+    }
+
+    Snapshot snapshot() const{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return {m_latencyMs, m_serviceRate, m_completed};
+    }
+
+private:
+    const double m_smoothing;
+    const Clock::duration m_window;
+    mutable std::mutex m_mutex;
+    double m_latencyMs;
+    double m_serviceRate;
+    uint64_t m_completed;
+    uint64_t m_windowCompleted;
+    Clock::time_point m_windowStart;
+};
+
+#endif
@@ -1,10 +1,34 @@
 #include <OdInferNode.hpp>
+#include <AllocationCounter.hpp>
 
 #include <utils/args_helper.hpp>
 #include <utils/config_factory.h>
 
 //#define raw_output 1
 
+namespace {
+// Traces "infer" intervals of frames from the start of their infer request to its completion
+class TracedAsyncPipeline : public AsyncPipeline{
+public:
+    using AsyncPipeline::AsyncPipeline;
+
+protected:
+    void onRequestStarted(const std::shared_ptr<MetaData>& metaData) override{
+        if (Tracer::enabled()) {
+            const auto& blob = metaData->asRef<BlobMetaData>().blob;
+            Tracer::begin("infer", blob->streamId, blob->frameId);
+        }
+    }
+
+    void onRequestCompleted(const std::shared_ptr<MetaData>& metaData) override{
+        if (Tracer::enabled()) {
+            const auto& blob = metaData->asRef<BlobMetaData>().blob;
+            Tracer::end("infer", blob->streamId, blob->frameId);
+        }
+    }
+};
+}  // namespace
+
 ODInferNode::ODInferNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config):
         hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_cfg(config){
 
@@ -14,7 +38,18 @@ std::shared_ptr<hva::hvaNodeWorker_t> ODInferNode::createNodeWorker() const{
     return std::shared_ptr<hva::hvaNodeWorker_t>(new ODInferNodeWorker((ODInferNode*)this, m_cfg));
 }
 
-ODInferNodeWorker::ODInferNodeWorker(hva::hvaNode_t* parentNode, const ODInferNode::Config& config):hva::hvaNodeWorker_t(parentNode){
+ODInferNodeWorker::ODInferNodeWorker(hva::hvaNode_t* parentNode, const ODInferNode::Config& config):hva::hvaNodeWorker_t(parentNode),
+    m_batchSize(config.batchSize), m_scheduler(config.scheduler),
+    m_reorder(config.keepStreamOrder, [this](const std::shared_ptr<hva::hvaBlob_t>& blob) {
+            Tracer::begin("queue", blob->streamId, blob->frameId);
+            sendOutput(blob, 0, ms(0));
+        }),
+    m_arena(std::make_shared<BlockArena>(config.poolSize)),
+    m_inferBufPool(BufPool<int, InferMeta>::create(config.poolSize, m_arena, [](InferBuf& buf) { buf.getMeta()->reset(); })),
+    m_blobPool(BlobPool<InferBuf, FrameBuf>::create(config.poolSize, m_arena)){
+    if (m_batchSize == 0) {
+        throw std::invalid_argument("ODInferNode batch size should be positive");
+    }
     const auto& strAnchors = split(config.anchors, ',');
     const auto& strMasks = split(config.masks, ',');
 
@@ -37,6 +72,9 @@ ODInferNodeWorker::ODInferNodeWorker(hva::hvaNode_t* parentNode, const ODInferNo
         HVA_DEBUG("No label file\n");
     }
 
+    if (config.nv12Input && config.architectureType != "yolo") {
+        throw std::invalid_argument("NV12 input is supported by yolo models only, got " + config.architectureType);
+    }
     if (config.architectureType == "centernet") {
         m_model.reset(new ModelCenterNet(config.modelFileName, static_cast<float>(config.confidenceThreshold), m_labels, config.layout));
     } else if (config.architectureType == "faceboxes") {
@@ -60,7 +98,7 @@ ODInferNodeWorker::ODInferNodeWorker(hva::hvaNode_t* parentNode, const ODInferNo
     } else if (config.architectureType == "ssd") {
         m_model.reset(new ModelSSD(config.modelFileName, static_cast<float>(config.confidenceThreshold), config.autoResize, m_labels, config.layout));
     } else if (config.architectureType == "yolo") {
-        m_model.reset(new ModelYolo(config.modelFileName,
+        ModelYolo* yoloModel = new ModelYolo(config.modelFileName,
                                   static_cast<float>(config.confidenceThreshold),
                                   config.autoResize,
                                   config.yolo_af,
@@ -68,31 +106,72 @@ ODInferNodeWorker::ODInferNodeWorker(hva::hvaNode_t* parentNode, const ODInferNo
                                   m_labels,
                                   m_anchors,
                                   m_masks,
-                                  config.layout));
+                                  config.layout);
+        yoloModel->setInGraphPostprocessing(config.yolo_ingraph_pp);
+        yoloModel->setNV12Input(config.nv12Input);
+        m_model.reset(yoloModel);
     } else {
         slog::err << "No model type or invalid model type (config.architectureType) provided: " + config.architectureType << slog::endl;
         return;
     }
     m_model->setInputsPreprocessing(config.reverse_input_channels, config.mean_values, config.scale_values);
+    m_model->setOutputsPrecision(config.output_precision);
+    std::string targetDevice = config.targetDevice;
+    if (!config.mockDelay.empty()) {
+        //--- Mock runs on CPU whatever device the model targets, requests run concurrently up to the number of CPU streams
+        m_model.reset(new MockModel(std::move(m_model), config.mockDelay, config.mockOutputsFile));
+        targetDevice = "CPU";
+    } else if (!config.recordOutputsFile.empty()) {
+        m_model.reset(new OutputsRecorder(std::move(m_model), config.recordOutputsFile));
+    }
     slog::info << ov::get_openvino_version() << slog::endl;
 
-    m_pipeline = std::make_shared<AsyncPipeline>(std::move(m_model),
-                               ConfigFactory::getUserConfig(config.targetDevice, config.nireq, config.nstreams, config.nthreads),
+    m_pipeline = std::make_shared<TracedAsyncPipeline>(std::move(m_model),
+                               ConfigFactory::getUserConfig(targetDevice, config.nireq, config.nstreams, config.nthreads),
                                m_core);
+    if (m_pipeline->getIdleRequestsCount() < m_batchSize) {
+        throw std::invalid_argument("Number of infer requests should be not less than batch size " + std::to_string(m_batchSize));
+    }
 }
 
 void ODInferNodeWorker::process(std::size_t batchIdx){
-    if (m_pipeline->isReadyToProcess()) {
+    //--- Whole HVA batch is submitted as a burst, so it is taken only when every blob of it gets a request
+    if (m_pipeline->getIdleRequestsCount() >= m_batchSize) {
         std::vector<std::shared_ptr<hva::hvaBlob_t>> vInput= hvaNodeWorker_t::getParentPtr()->getBatchedInput(batchIdx, std::vector<size_t> {0});
-        if(vInput.size() != 0) {
-            HVA_DEBUG("DetectionNode received blob with frameid %u and streamid %u", vInput[0]->frameId, vInput[0]->streamId);
-            auto cvFrame = vInput[0]->get<int, ImageMetaData>(0)->getMeta()->img;
-            auto startTime = vInput[0]->get<int, ImageMetaData>(0)->getMeta()->timeStamp;
-            m_frameNum = m_pipeline->submitData(ImageInputData(cvFrame),
-                                               std::make_shared<ImageMetaData>(cvFrame, startTime));
-
-            std::unique_lock<std::mutex> lock(m_blobMutex);
-            m_inferWaitingQueue.push(vInput[0]);
+        for (const auto& input : vInput) {
+            HVA_DEBUG("DetectionNode received blob with frameid %u and streamid %u", input->frameId, input->streamId);
+            Tracer::end("queue", input->streamId, input->frameId);
+            TraceSpan span("ODInferNode.submit", input->streamId, input->frameId);
+            uint64_t streamSeq = m_reorder.nextSeq(input->streamId);
+            if (*input->get<int, ImageMetaData>(0)->getPtr()) {
+                //--- EOF blob has no frame, it is passed on after all earlier frames of its stream
+                m_reorder.push(input->streamId, streamSeq, makeOutputBlob(input, acquireInferBuf(input)));
+                continue;
+            }
+            auto cvFrame = input->get<int, ImageMetaData>(0)->getMeta()->img;
+            auto startTime = input->get<int, ImageMetaData>(0)->getMeta()->timeStamp;
+            const bool nv12 = input->get<int, ImageMetaData>(0)->getMeta()->nv12;
+            uint64_t allocationsBefore = threadAllocationCount();
+            if (m_scheduler && !m_scheduler->shouldDetect(input->streamId)) {
+                //--- Skipped frame keeps its place in the stream order, TrackerNode propagates tracks over it
+                std::shared_ptr<InferBuf> skippedBuf = acquireInferBuf(input);
+                InferMeta* skippedMeta = skippedBuf->getMeta();
+                skippedMeta->detected = false;
+                auto skippedFrame = std::allocate_shared<ImageMetaData>(ArenaAllocator<ImageMetaData>(m_arena), cvFrame, startTime);
+                skippedFrame->nv12 = nv12;
+                skippedMeta->detResult.metaData = skippedFrame;
+                m_reorder.push(input->streamId, streamSeq, makeOutputBlob(input, skippedBuf));
+                m_blobAllocations += threadAllocationCount() - allocationsBefore;
+                continue;
+            }
+            auto blobMeta = std::allocate_shared<BlobMetaData>(ArenaAllocator<BlobMetaData>(m_arena), input, streamSeq, cvFrame, startTime);
+            blobMeta->nv12 = nv12;
+            m_blobAllocations += threadAllocationCount() - allocationsBefore;
+            m_pipeline->submitData(ImageInputData(cvFrame), blobMeta);
+        }
+        if (!vInput.empty()) {
+            m_batchCount++;
+            m_submittedCount += vInput.size();
         }
     } else {
         HVA_DEBUG("DetectionNode has no idle infer request\n");
@@ -108,23 +187,15 @@ void ODInferNodeWorker::deinit(){
 void ODInferNodeWorker::processByFirstRun(std::size_t batchIdx) {
     m_resultThread = std::make_shared<std::thread> ([&]() {
         while (m_exec) {
-            //m_pipeline->waitForData();
-            m_pipeline->waitForResult();
-
-            std::shared_ptr<hva::hvaBlob_t> pendingBlob;
-            {
-                std::unique_lock<std::mutex> lock(m_blobMutex);
-                pendingBlob = m_inferWaitingQueue.front();
-                m_inferWaitingQueue.pop();
-            }
+            //--- Any completed request is taken, its metadata tells which blob it belongs to
+            m_pipeline->waitForResult(false);
 
-            std::shared_ptr<hva::hvaBlob_t> blob(new hva::hvaBlob_t());
-            InferMeta *ptrInferMeta = new InferMeta;
             //Post-process
-            auto nnresult = m_pipeline->getResult();
+            auto postprocessBegin = Tracer::Clock::now();
+            auto nnresult = m_pipeline->getResult(false);
             if (nnresult) {
-                DetectionResult result = nnresult->asRef<DetectionResult>();
 #if raw_output
+                const DetectionResult& result = nnresult->asRef<DetectionResult>();
                 // Visualizing result data over source image
                 slog::debug << " -------------------- Frame # " << result.frameId << "--------------------" << slog::endl;
                 slog::debug << " Class ID  | Confidence | XMIN | YMIN | XMAX | YMAX " << slog::endl;
@@ -135,31 +206,59 @@ void ODInferNodeWorker::processByFirstRun(std::size_t batchIdx) {
                                 << slog::endl;
                 }
 #endif
-                ptrInferMeta->detResult = result;
             } else {
                 HVA_WARNING("No NN results, should not happen\n");
                 return;
             }
 
-            ptrInferMeta->frameId = pendingBlob->frameId;
-            blob->emplace<int, InferMeta>(nullptr, 0, ptrInferMeta, [](int *payload, InferMeta * meta) {
-                    if (payload!=nullptr) {
-                        delete payload;
-                    }
-                    delete meta;
-                });
-            blob->push(pendingBlob->get<int, ImageMetaData>(0));
-            blob->frameId = pendingBlob->frameId;
-            blob->streamId = pendingBlob->streamId;
+            auto& blobMeta = nnresult->metaData->asRef<BlobMetaData>();
+            std::shared_ptr<hva::hvaBlob_t> pendingBlob = std::move(blobMeta.blob);
+            TraceSpan span("ODInferNode.result", pendingBlob->streamId, pendingBlob->frameId);
+            Tracer::span("ODInferNode.postprocess", pendingBlob->streamId, pendingBlob->frameId, postprocessBegin, Tracer::Clock::now());
+            uint64_t allocationsBefore = threadAllocationCount();
+            std::shared_ptr<InferBuf> inferBuf = acquireInferBuf(pendingBlob);
+            InferMeta* ptrInferMeta = inferBuf->getMeta();
+            //--- Copy assignment reuses the object vector of the recycled InferMeta
+            ptrInferMeta->detResult = nnresult->asRef<DetectionResult>();
+            // Results keep their metadata, so the input blob is not referenced past this point
+            auto frame = std::allocate_shared<ImageMetaData>(ArenaAllocator<ImageMetaData>(m_arena), blobMeta.img, blobMeta.timeStamp);
+            frame->nv12 = blobMeta.nv12;
+            ptrInferMeta->detResult.metaData = frame;
+            std::shared_ptr<hva::hvaBlob_t> outputBlob = makeOutputBlob(pendingBlob, inferBuf);
+            m_blobAllocations += threadAllocationCount() - allocationsBefore;
+            m_throughputMetrics.update(blobMeta.timeStamp);
 
-            sendOutput(blob, 0, ms(0));
+            m_reorder.push(pendingBlob->streamId, blobMeta.streamSeq, outputBlob);
         }
     });
 }
 
+std::shared_ptr<ODInferNodeWorker::InferBuf> ODInferNodeWorker::acquireInferBuf(const std::shared_ptr<hva::hvaBlob_t>& input) {
+    std::shared_ptr<InferBuf> inferBuf = m_inferBufPool->acquire();
+    inferBuf->getMeta()->frameId = input->frameId;
+    return inferBuf;
+}
+
+std::shared_ptr<hva::hvaBlob_t> ODInferNodeWorker::makeOutputBlob(const std::shared_ptr<hva::hvaBlob_t>& input, const std::shared_ptr<InferBuf>& inferBuf) {
+    //--- Frame buf is shared with the input blob, it returns to FrameReaderNode when both are released
+    return m_blobPool->acquire(input->frameId, input->streamId, inferBuf, input->get<int, ImageMetaData>(0));
+}
+
 void ODInferNodeWorker::processByLastRun(std::size_t batchIdx) {
     if (m_resultThread && m_resultThread->joinable()) {
         m_exec = false;
         m_resultThread->join();
     }
+
+    auto throughput = m_throughputMetrics.getTotal();
+    slog::info << "Detection (batch size " << m_batchSize << ")" << slog::endl;
+    slog::info << "\tThroughput:\t" << std::fixed << std::setprecision(1) << throughput.fps << " FPS" << slog::endl;
+    slog::info << "\tLatency:\t" << throughput.latency << " ms" << slog::endl;
+    slog::info << "\tAvg batch:\t" << (m_batchCount ? static_cast<double>(m_submittedCount) / m_batchCount : 0.0) << slog::endl;
+    slog::info << "\tPreprocessing:\t" << m_pipeline->getPreprocessMetrics().getTotal().latency << " ms" << slog::endl;
+    slog::info << "\tInference:\t" << m_pipeline->getInferenceMetircs().getTotal().latency << " ms" << slog::endl;
+    slog::info << "\tPostprocessing:\t" << m_pipeline->getPostprocessMetrics().getTotal().latency << " ms" << slog::endl;
+    uint64_t blobAllocations = m_blobAllocations;
+    slog::info << "\tBlob building allocations:\t" << blobAllocations << " total, " <<
+        (m_submittedCount ? static_cast<double>(blobAllocations) / m_submittedCount : 0.0) << " per frame" << slog::endl;
 }
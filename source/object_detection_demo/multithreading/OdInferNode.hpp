@@ -4,6 +4,8 @@
 #include <thread>
 #include <iostream>
 #include <atomic>
+#include <map>
+#include <unordered_map>
 
 #include <inc/api/hvaPipeline.hpp>
 // #include <inc/api/hvaBlob.hpp>
@@ -20,6 +22,7 @@
 #include <models/detection_model_ssd.h>
 #include <models/detection_model_yolo.h>
 #include <models/input_data.h>
+#include <models/mock_model.h>
 #include <models/model_base.h>
 #include <models/results.h>
 
@@ -27,10 +30,26 @@
 #include <pipelines/metadata.h>
 
 #include <common.hpp>
+#include <BlobPool.hpp>
+#include <DetectionScheduler.hpp>
+#include <StreamReorder.hpp>
+#include <Tracer.hpp>
 
 
 using ms = std::chrono::milliseconds;
 
+// Carries the input blob through AsyncPipeline, so a result maps back to its blob
+// whatever order infer requests complete in
+struct BlobMetaData : public ImageMetaData {
+    std::shared_ptr<hva::hvaBlob_t> blob;
+    uint64_t streamSeq;  //Submission order of the blob within its stream
+
+    BlobMetaData(const std::shared_ptr<hva::hvaBlob_t>& blob, uint64_t streamSeq, cv::Mat img,
+                 std::chrono::steady_clock::time_point timeStamp) :
+        ImageMetaData(img, timeStamp), blob(blob), streamSeq(streamSeq) {
+    }
+};
+
 class ODInferNode : public hva::hvaNode_t{
 public:
     struct Config{
@@ -45,17 +64,28 @@ public:
         float iouThreshold = 0.5;
 
         bool autoResize = false;  //Optional. Enables resizable input with support of ROI crop & auto resize.
+        bool nv12Input = false;  //Optional. Frames are NV12, converted to BGR and resized inside the compiled model (YOLO only).
 
+        bool keepStreamOrder = true;  //Emit frames of each stream in submission order. Frames of different streams are never held back by each other.
+        std::shared_ptr<DetectionScheduler> scheduler = nullptr;  //Optional. Frames it skips are passed on without inference, for TrackerNode to fill.
+        std::size_t poolSize = 64;  //Number of output blobs kept for reuse, should cover frames of all streams in flight downstream.
+        std::size_t batchSize = 1;  //Number of blobs taken from one HVA batch and submitted as a burst, should match hvaBatchingConfig_t::batchSize of the node.
         uint32_t nireq = 0;  //Optional. Number of infer requests. If this option is omitted, number of infer requests is determined automatically.
         uint32_t nthreads = 0;  //Optional. Number of threads.
         std::string nstreams = "";  //Optional. Number of streams to use for inference on the CPU or/and GPU in throughput mode (for HETERO and MULTI device cases use format <device1>:<nstreams1>,<device2>:<nstreams2> or just <nstreams>).
 
         bool yolo_af = true;
+        bool yolo_ingraph_pp = false;  //Optional. Decode boxes and run NMS inside the compiled model (YOLO only).
+        std::string output_precision = "f32";  //Optional. Element type of raw model outputs: f32 or f16 (YOLO without yolo_ingraph_pp only, other models keep f32).
         std::string anchors = "";
         std::string masks = "";
         bool reverse_input_channels = false;
         std::string mean_values = "";
         std::string scale_values = "";
+
+        std::string mockDelay = "";  //Optional. Mocks inference on CPU, canned outputs are returned after this delay in ms, e.g. "5" or "normal:5:1", see MockDelay.
+        std::string mockOutputsFile = "";  //Optional. Canned outputs of the mock, written with recordOutputsFile. Outputs are zeros if it is empty.
+        std::string recordOutputsFile = "";  //Optional. Writes raw outputs of the first inferred frame, to be used as canned outputs of the mock.
     };
 
     ODInferNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config);
@@ -88,10 +118,26 @@ private:
 
     ov::Core m_core;
 
+    using InferBuf = hva::hvaBuf_t<int, InferMeta>;
+    using FrameBuf = hva::hvaBuf_t<int, ImageMetaData>;
+
+    std::shared_ptr<InferBuf> acquireInferBuf(const std::shared_ptr<hva::hvaBlob_t>& input);
+    std::shared_ptr<hva::hvaBlob_t> makeOutputBlob(const std::shared_ptr<hva::hvaBlob_t>& input, const std::shared_ptr<InferBuf>& inferBuf);
+
     std::shared_ptr<std::thread> m_resultThread;
     std::atomic_bool m_exec {true};
-    std::mutex m_blobMutex;
-    std::queue<std::shared_ptr<hva::hvaBlob_t>> m_inferWaitingQueue;
-    int64_t m_frameNum = -1;
+
+    std::size_t m_batchSize;
+    uint64_t m_batchCount = 0;
+    uint64_t m_submittedCount = 0;
+    PerformanceMetrics m_throughputMetrics;  //Updated by the result thread with frame read time, so latency is end-to-end up to this node
+
+    std::shared_ptr<DetectionScheduler> m_scheduler;
+    StreamReorder m_reorder;
+
+    std::shared_ptr<BlockArena> m_arena;  //Control blocks of pooled blobs and bufs, metadata passed through AsyncPipeline
+    std::shared_ptr<BufPool<int, InferMeta>> m_inferBufPool;
+    std::shared_ptr<BlobPool<InferBuf, FrameBuf>> m_blobPool;  //Output blobs hold the InferMeta buf and the frame buf of the input blob
+    std::atomic<uint64_t> m_blobAllocations {0};  //Heap allocations made to build output blobs and their metadata, inference is not counted
 };
 #endif
@@ -0,0 +1,289 @@
+#include <SinkNode.hpp>
+
+#include <cstdio>
+#include <iomanip>
+#include <stdexcept>
+
+SinkNode::Config SinkNode::parseConfig(const std::string& sink){
+    Config config;
+    const auto delimiter = sink.find(':');
+    const std::string mode = sink.substr(0, delimiter);
+    if (delimiter != std::string::npos) {
+        config.output = sink.substr(delimiter + 1);
+    }
+    if (mode == "null") {
+        config.mode = Mode::Null;
+        return config;
+    } else if (mode == "json") {
+        config.mode = Mode::Json;
+    } else if (mode == "binary") {
+        config.mode = Mode::Binary;
+    } else if (mode == "video") {
+        config.mode = Mode::Video;
+    } else {
+        throw std::invalid_argument("Unknown sink mode: " + mode);
+    }
+    if (config.output.empty()) {
+        throw std::invalid_argument("Sink mode " + mode + " requires an output file, e.g. " + mode + ":<file>");
+    }
+    return config;
+}
+
+SinkNode::SinkNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config):
+        hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_cfg(config){
+    if (m_cfg.mode == Mode::Video && !m_cfg.segmentFirstFrames.empty()) {
+        throw std::invalid_argument("Video sink can't write segments of one video, use a json or binary sink");
+    }
+}
+
+std::shared_ptr<hva::hvaNodeWorker_t> SinkNode::createNodeWorker() const{
+    return std::shared_ptr<hva::hvaNodeWorker_t>(new SinkNodeWorker((SinkNode*)this, m_cfg));
+}
+
+SinkNodeWorker::SinkNodeWorker(hva::hvaNode_t* parentNode, const SinkNode::Config& config):hva::hvaNodeWorker_t(parentNode),
+        m_cfg(config){
+
+}
+
+static std::string escapeJson(const std::string& str){
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            //Control characters, e.g. of a label file with CRLF line ends, as \u00XX
+            static const char hex[] = "0123456789abcdef";
+            escaped += "\\u00";
+            escaped += hex[(c >> 4) & 0xf];
+            escaped += hex[c & 0xf];
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+static std::string streamFileName(const std::string& output, int streamId){
+    const auto slash = output.find_last_of("/\\");
+    const auto dot = output.rfind('.');
+    const auto extPos = (dot != std::string::npos && (slash == std::string::npos || dot > slash)) ? dot : output.size();
+    return output.substr(0, extPos) + "_" + std::to_string(streamId) + output.substr(extPos);
+}
+
+void SinkNodeWorker::process(std::size_t batchIdx){
+    std::vector<std::shared_ptr<hva::hvaBlob_t>> vInput= hvaNodeWorker_t::getParentPtr()->getBatchedInput(batchIdx, std::vector<size_t> {0});
+    if (vInput.size() == 0) {
+        return;
+    }
+    const auto& input = vInput[0];
+    HVA_DEBUG("SinkNode received blob with frameid %u and streamid %u", input->frameId, input->streamId);
+    Tracer::end("queue", input->streamId, input->frameId);
+    TraceSpan span("SinkNode", input->streamId, input->frameId);
+
+    const bool segmented = !m_cfg.segmentFirstFrames.empty();
+    auto eof = input->get<int, ImageMetaData>(1)->getPtr();
+    if (*eof) {
+        if (segmented) {
+            endSegment(input->streamId);
+        }
+        return;
+    }
+    auto timeStamp = input->get<int, ImageMetaData>(1)->getMeta()->timeStamp;
+    const double sourceScale = input->get<int, ImageMetaData>(1)->getMeta()->sourceScale;
+    const auto& result = input->get<int, InferMeta>(0)->getMeta()->detResult;
+
+    //--- Segments of one video are written as one stream, frames numbered from the beginning of the video
+    const int streamId = segmented ? 0 : input->streamId;
+    const int frameId = segmented ? static_cast<int>(m_cfg.segmentFirstFrames.at(input->streamId)) + input->frameId : input->frameId;
+
+    switch (m_cfg.mode) {
+    case SinkNode::Mode::Null:
+        break;
+    case SinkNode::Mode::Json:
+        writeJson(segmented ? segmentOutput(input->streamId) : m_file, streamId, frameId, result, sourceScale);
+        break;
+    case SinkNode::Mode::Binary:
+        writeBinary(segmented ? segmentOutput(input->streamId) : m_file, streamId, frameId, result, sourceScale);
+        break;
+    case SinkNode::Mode::Video: {
+        std::unique_lock<std::mutex> lock(m_encoderMutex);
+        m_encoderCond.wait(lock, [this] { return m_encoderQueue.size() < m_cfg.videoQueueSize; });
+        m_encoderQueue.push_back(input);
+        m_encoderCond.notify_all();
+        //--- Metrics are updated by the encoder thread once the frame is written
+        return;
+    }
+    }
+    updateMetrics(input->streamId, timeStamp);
+}
+
+void SinkNodeWorker::writeJson(std::ostream& out, int streamId, int frameId, const DetectionResult& result, double sourceScale){
+    out << "{\"stream\":" << streamId << ",\"frame\":" << frameId << ",\"objects\":[";
+    for (size_t i = 0; i < result.objects.size(); ++i) {
+        const auto& obj = result.objects[i];
+        out << (i ? "," : "") << "{\"label\":\"" << escapeJson(obj.label) << "\",\"id\":" << obj.labelID <<
+            ",\"confidence\":" << obj.confidence << ",\"box\":[" << obj.x * sourceScale << "," << obj.y * sourceScale << "," <<
+            obj.width * sourceScale << "," << obj.height * sourceScale << "]";
+        if (!obj.topLabels.empty()) {
+            out << ",\"classes\":[";
+            for (size_t j = 0; j < obj.topLabels.size(); ++j) {
+                out << (j ? "," : "") << "{\"label\":\"" << escapeJson(obj.topLabels[j].label) << "\",\"id\":" <<
+                    obj.topLabels[j].id << ",\"score\":" << obj.topLabels[j].score << "}";
+            }
+            out << "]";
+        }
+        out << "}";
+    }
+    out << "]}\n";
+}
+
+void SinkNodeWorker::writeBinary(std::ostream& out, int streamId, int frameId, const DetectionResult& result, double sourceScale){
+    const int32_t header[2] = {streamId, frameId};
+    const uint32_t objectsNum = static_cast<uint32_t>(result.objects.size());
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&objectsNum), sizeof(objectsNum));
+    for (const auto& obj : result.objects) {
+        const int32_t labelID = static_cast<int32_t>(obj.labelID);
+        const float scale = static_cast<float>(sourceScale);
+        const float values[5] = {obj.confidence, obj.x * scale, obj.y * scale, obj.width * scale, obj.height * scale};
+        out.write(reinterpret_cast<const char*>(&labelID), sizeof(labelID));
+        out.write(reinterpret_cast<const char*>(values), sizeof(values));
+    }
+}
+
+static std::string segmentFileName(const std::string& output, std::size_t segment){
+    return output + ".segment" + std::to_string(segment);
+}
+
+std::ostream& SinkNodeWorker::segmentOutput(int streamId){
+    if (static_cast<std::size_t>(streamId) == m_currentSegment) {
+        return m_file;
+    }
+    auto& pending = m_pendingSegments.at(streamId);
+    if (!pending) {
+        //--- Binary either way, the text mode of the output translates line ends once records are appended
+        pending.reset(new std::fstream(segmentFileName(m_cfg.output, streamId),
+            std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary));
+        if (!pending->is_open()) {
+            throw std::runtime_error("Can't open the temporary file of segment " + std::to_string(streamId));
+        }
+    }
+    return *pending;
+}
+
+void SinkNodeWorker::appendPendingSegment(std::size_t segment){
+    auto& pending = m_pendingSegments[segment];
+    if (!pending) {
+        return;
+    }
+    pending->seekg(0);
+    if (pending->peek() != std::char_traits<char>::eof()) {
+        m_file << pending->rdbuf();
+    }
+    pending.reset();
+    std::remove(segmentFileName(m_cfg.output, segment).c_str());
+}
+
+void SinkNodeWorker::endSegment(int streamId){
+    m_endedSegments.at(streamId) = true;
+    while (m_currentSegment < m_endedSegments.size() && m_endedSegments[m_currentSegment]) {
+        m_currentSegment++;
+        if (m_currentSegment < m_pendingSegments.size()) {
+            //--- The next segment catches up with what it has done so far and writes to the file from now on
+            appendPendingSegment(m_currentSegment);
+        }
+    }
+}
+
+void SinkNodeWorker::encodeFrames(){
+    while (true) {
+        std::shared_ptr<hva::hvaBlob_t> blob;
+        {
+            std::unique_lock<std::mutex> lock(m_encoderMutex);
+            m_encoderCond.wait(lock, [this] { return m_encoderStop || !m_encoderQueue.empty(); });
+            if (m_encoderQueue.empty()) {
+                return;
+            }
+            blob = m_encoderQueue.front();
+            m_encoderQueue.pop_front();
+        }
+        m_encoderCond.notify_all();
+        TraceSpan span("SinkNode.encode", blob->streamId, blob->frameId);
+
+        auto timeStamp = blob->get<int, ImageMetaData>(1)->getMeta()->timeStamp;
+        auto& result = blob->get<int, InferMeta>(0)->getMeta()->detResult;
+        cv::Mat outFrame = DisplayNodeWorker::renderDetectionData(result, *m_palette, m_outputTransform);
+
+        auto& writer = m_writers[blob->streamId];
+        if (!writer) {
+            writer.reset(new LazyVideoWriter(streamFileName(m_cfg.output, blob->streamId), m_cfg.videoFps, 0));
+        }
+        writer->write(outFrame);
+        updateMetrics(blob->streamId, timeStamp);
+    }
+}
+
+void SinkNodeWorker::updateMetrics(int streamId, std::chrono::steady_clock::time_point timeStamp){
+    m_metrics.update(timeStamp);
+    m_streamMetrics[streamId].update(timeStamp);
+    if (m_cfg.latencyMonitor) {
+        m_cfg.latencyMonitor->update(timeStamp);
+    }
+}
+
+void SinkNodeWorker::init(){
+}
+
+void SinkNodeWorker::deinit(){
+}
+
+void SinkNodeWorker::processByFirstRun(std::size_t batchIdx) {
+    switch (m_cfg.mode) {
+    case SinkNode::Mode::Json:
+        m_file.open(m_cfg.output);
+        break;
+    case SinkNode::Mode::Binary:
+        m_file.open(m_cfg.output, std::ios::binary);
+        break;
+    case SinkNode::Mode::Video:
+        m_palette.reset(new ColorPalette(100));
+        m_encoderThread = std::thread(&SinkNodeWorker::encodeFrames, this);
+        break;
+    default:
+        break;
+    }
+    if ((m_cfg.mode == SinkNode::Mode::Json || m_cfg.mode == SinkNode::Mode::Binary) && !m_file.is_open()) {
+        throw std::runtime_error("Can't open sink output " + m_cfg.output);
+    }
+    m_pendingSegments.resize(m_cfg.segmentFirstFrames.size());
+    m_endedSegments.assign(m_cfg.segmentFirstFrames.size(), false);
+}
+
+void SinkNodeWorker::processByLastRun(std::size_t batchIdx) {
+    if (m_encoderThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_encoderMutex);
+            m_encoderStop = true;
+        }
+        m_encoderCond.notify_all();
+        m_encoderThread.join();
+    }
+    if (m_file.is_open()) {
+        //--- Segments whose earlier segments never ended, e.g. on a stop before the end of the video
+        for (std::size_t i = m_currentSegment + 1; i < m_pendingSegments.size(); ++i) {
+            appendPendingSegment(i);
+        }
+        m_file.close();
+    }
+
+    auto total = m_metrics.getTotal();
+    slog::info << "Sink" << slog::endl;
+    slog::info << "\tThroughput:\t" << std::fixed << std::setprecision(1) << total.fps << " FPS" << slog::endl;
+    slog::info << "\tLatency:\t" << total.latency << " ms" << slog::endl;
+    for (const auto& stream : m_streamMetrics) {
+        auto metrics = stream.second.getTotal();
+        slog::info << "\tStream #" << stream.first << ":\t" << metrics.fps << " FPS, " << metrics.latency << " ms" << slog::endl;
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef SINK_NODE_HPP
+#define SINK_NODE_HPP
+
+#include <thread>
+#include <iostream>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <inc/api/hvaPipeline.hpp>
+
+#include <opencv2/core.hpp>
+
+#include <utils/ocv_common.hpp>
+#include <utils/performance_metrics.hpp>
+
+#include <DisplayNode.hpp>
+#include <LatencyMonitor.hpp>
+#include <Tracer.hpp>
+
+using ms = std::chrono::milliseconds;
+
+// Headless sink. Every mode reports end-to-end throughput and latency, measured from
+// ImageMetaData::timeStamp set when the frame was read, in total and per stream.
+class SinkNode : public hva::hvaNode_t{
+public:
+    enum class Mode{
+        Null,    //Counts and discards frames
+        Json,    //Writes detections of every frame as a JSON line
+        Binary,  //Writes detections of every frame as a binary record, see SinkNodeWorker::writeBinary
+        Video    //Renders detections and encodes frames on a separate thread, one file per stream
+    };
+
+    struct Config{
+        Mode mode = Mode::Null;
+        std::string output = "";  //Output file. In Video mode stream N is written to <name>_N<extension>
+        double videoFps = 25.0;  //Frame rate of encoded videos
+        std::size_t videoQueueSize = 16;  //Frames waiting for encoding, the node waits for the encoder when the queue is full
+        std::shared_ptr<LatencyMonitor> latencyMonitor = nullptr;  //Optional, told of every completed frame
+        std::vector<std::size_t> segmentFirstFrames;  //Optional. Streams are consecutive segments of one video beginning at these frames, see splitVideo().
+                                                      //Json and binary sinks then write them as stream 0 in frame order, Video mode rejects them
+    };
+
+    // Parses "null", "json:<file>", "binary:<file>" or "video:<file>"
+    static Config parseConfig(const std::string& sink);
+
+    SinkNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config);
+
+    virtual std::shared_ptr<hva::hvaNodeWorker_t> createNodeWorker() const override;
+
+private:
+    Config m_cfg;
+};
+
+class SinkNodeWorker : public hva::hvaNodeWorker_t{
+public:
+    SinkNodeWorker(hva::hvaNode_t* parentNode, const SinkNode::Config& config);
+
+    virtual void process(std::size_t batchIdx) override;
+    virtual void init() override;
+    virtual void deinit() override;
+
+    virtual void processByFirstRun(std::size_t batchIdx) override;
+    virtual void processByLastRun(std::size_t batchIdx) override;
+
+private:
+    // Boxes are written in coordinates of the source, i.e. scaled by sourceScale of a reduced frame
+    void writeJson(std::ostream& out, int streamId, int frameId, const DetectionResult& result, double sourceScale);
+    // Record layout, little endian: int32 streamId, int32 frameId, uint32 objectsNum,
+    // then objectsNum times: int32 labelID, float confidence, float x, float y, float width, float height
+    void writeBinary(std::ostream& out, int streamId, int frameId, const DetectionResult& result, double sourceScale);
+    // Records of the earliest segment not ended yet go to the file, later segments are spilled to temporary files
+    // next to it, <output>.segment<N>, and appended once the segments before them end
+    std::ostream& segmentOutput(int streamId);
+    void endSegment(int streamId);
+    void appendPendingSegment(std::size_t segment);
+    void encodeFrames();
+    void updateMetrics(int streamId, std::chrono::steady_clock::time_point timeStamp);
+
+    SinkNode::Config m_cfg;
+    std::ofstream m_file;
+
+    //--- Segments of one video, by streamId
+    std::vector<std::unique_ptr<std::fstream>> m_pendingSegments;  //Opened on the first record of a segment
+    std::vector<bool> m_endedSegments;
+    std::size_t m_currentSegment = 0;
+
+    PerformanceMetrics m_metrics;
+    std::map<int, PerformanceMetrics> m_streamMetrics;  //Keyed by streamId
+
+    //--- Video mode, blobs are kept alive until encoded
+    std::thread m_encoderThread;
+    std::mutex m_encoderMutex;
+    std::condition_variable m_encoderCond;
+    std::deque<std::shared_ptr<hva::hvaBlob_t>> m_encoderQueue;
+    bool m_encoderStop = false;
+    std::map<int, std::unique_ptr<LazyVideoWriter>> m_writers;  //Keyed by streamId
+    std::unique_ptr<ColorPalette> m_palette;
+    OutputTransform m_outputTransform;
+};
+#endif
@@ -0,0 +1,62 @@
+#ifndef STREAM_REORDER_HPP
+#define STREAM_REORDER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <inc/api/hvaPipeline.hpp>
+
+// Lets a node finish frames out of order and still emit every stream in order. Frames finished
+// ahead of an earlier frame of the same stream are held, frames of other streams are never held back.
+class StreamReorder{
+public:
+    using Send = std::function<void(const std::shared_ptr<hva::hvaBlob_t>&)>;
+
+    // keepOrder == false passes blobs to send as soon as they are pushed
+    StreamReorder(bool keepOrder, Send send): m_keepOrder(keepOrder), m_send(std::move(send)){}
+
+    // Returns the order number of the next frame of the stream, to be passed to push() when it is finished
+    uint64_t nextSeq(int streamId){
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_streams[streamId].submitSeq++;
+    }
+
+    // send is called under the lock, so frames pushed from several threads leave in stream order
+    void push(int streamId, uint64_t seq, const std::shared_ptr<hva::hvaBlob_t>& blob){
+        if (!m_keepOrder) {
+            m_send(blob);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& stream = m_streams[streamId];
+        if (seq != stream.emitSeq) {
+            stream.completed.emplace(seq, blob);
+            return;
+        }
+        m_send(blob);
+        stream.emitSeq++;
+        for (auto it = stream.completed.begin(); it != stream.completed.end() && it->first == stream.emitSeq;
+             it = stream.completed.erase(it)) {
+            m_send(it->second);
+            stream.emitSeq++;
+        }
+    }
+
+private:
+    struct Stream{
+        uint64_t submitSeq = 0;  //Order number of the next frame taken by the node
+        uint64_t emitSeq = 0;  //Order number of the next frame to emit
+        std::map<uint64_t, std::shared_ptr<hva::hvaBlob_t>> completed;  //Frames finished ahead of emitSeq
+    };
+
+    const bool m_keepOrder;
+    Send m_send;
+    std::mutex m_mutex;
+    std::unordered_map<int, Stream> m_streams;
+};
+
+#endif
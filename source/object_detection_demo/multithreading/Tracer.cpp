@@ -0,0 +1,211 @@
+#include <Tracer.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace {
+struct TraceEvent{
+    const char* name;
+    char phase;  //'X' span, 'b' async begin, 'e' async end
+    int streamId;
+    int frameId;
+    Tracer::Clock::time_point begin;
+    Tracer::Clock::duration duration;
+};
+
+// Written by its thread only. size is published with release, so a dump reads complete events
+struct ThreadBuffer{
+    ThreadBuffer(std::size_t capacity, unsigned tid): events(capacity), tid(tid){}
+
+    std::vector<TraceEvent> events;
+    std::atomic<std::size_t> size {0};
+    std::atomic<uint64_t> dropped {0};
+    const unsigned tid;
+};
+
+struct Registry{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;  //Kept after their threads exit
+    std::size_t eventsPerThread = 0;
+    std::string fileName;
+    Tracer::Clock::time_point origin;
+};
+
+Registry& registry(){
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer& threadBuffer(){
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        buffer = std::make_shared<ThreadBuffer>(reg.eventsPerThread, static_cast<unsigned>(reg.buffers.size()));
+        reg.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void record(const char* name, char phase, int streamId, int frameId, Tracer::Clock::time_point begin, Tracer::Clock::duration duration){
+    ThreadBuffer& buffer = threadBuffer();
+    const std::size_t idx = buffer.size.load(std::memory_order_relaxed);
+    if (idx >= buffer.events.size()) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[idx] = TraceEvent{name, phase, streamId, frameId, begin, duration};
+    buffer.size.store(idx + 1, std::memory_order_release);
+}
+
+double toUs(Tracer::Clock::duration duration){
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+std::vector<std::shared_ptr<ThreadBuffer>> snapshot(Tracer::Clock::time_point* origin = nullptr){
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (origin) {
+        *origin = reg.origin;
+    }
+    return reg.buffers;
+}
+
+// Nearest rank percentile of sorted values
+double percentile(const std::vector<double>& sorted, double p){
+    std::size_t rank = static_cast<std::size_t>(p / 100.0 * sorted.size() + 0.5);
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+}  // namespace
+
+std::atomic<bool> Tracer::s_enabled {false};
+
+void Tracer::enable(const std::string& fileName, std::size_t eventsPerThread){
+    if (eventsPerThread == 0) {
+        throw std::invalid_argument("Tracer needs room for at least one event per thread");
+    }
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.eventsPerThread = eventsPerThread;
+        reg.fileName = fileName;
+        reg.origin = Clock::now();
+    }
+    s_enabled.store(true);
+}
+
+void Tracer::disable(){
+    s_enabled.store(false);
+}
+
+void Tracer::span(const char* name, int streamId, int frameId, Clock::time_point begin, Clock::time_point end){
+    if (enabled()) {
+        record(name, 'X', streamId, frameId, begin, end - begin);
+    }
+}
+
+void Tracer::begin(const char* name, int streamId, int frameId){
+    if (enabled()) {
+        record(name, 'b', streamId, frameId, Clock::now(), Clock::duration::zero());
+    }
+}
+
+void Tracer::end(const char* name, int streamId, int frameId){
+    if (enabled()) {
+        record(name, 'e', streamId, frameId, Clock::now(), Clock::duration::zero());
+    }
+}
+
+void Tracer::clear(){
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& buffer : reg.buffers) {
+        buffer->size.store(0, std::memory_order_release);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+    reg.origin = Clock::now();
+}
+
+std::size_t Tracer::dump(){
+    std::string fileName;
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        fileName = registry().fileName;
+    }
+    return dump(fileName);
+}
+
+std::size_t Tracer::dump(const std::string& fileName){
+    std::ofstream file(fileName);
+    if (!file) {
+        throw std::runtime_error("Can't open trace file " + fileName);
+    }
+    Clock::time_point origin;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers = snapshot(&origin);
+
+    std::size_t written = 0;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (const auto& buffer : buffers) {
+        const std::size_t size = buffer->size.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < size; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            file << (written++ ? ",\n" : "\n") << "{\"name\":\"" << event.name << "\",\"cat\":\"pipeline\",\"ph\":\"" << event.phase <<
+                "\",\"pid\":0,\"tid\":" << buffer->tid << ",\"ts\":" << toUs(event.begin - origin);
+            if (event.phase == 'X') {
+                file << ",\"dur\":" << toUs(event.duration);
+            } else {
+                //--- Async events pair up by name and id, one id per frame
+                file << ",\"id\":\"" << event.streamId << ":" << event.frameId << "\"";
+            }
+            file << ",\"args\":{\"stream\":" << event.streamId << ",\"frame\":" << event.frameId << "}}";
+        }
+        if (buffer->dropped) {
+            file << (written++ ? ",\n" : "\n") << "{\"name\":\"dropped events\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":" << buffer->tid <<
+                ",\"ts\":0,\"args\":{\"count\":" << buffer->dropped << "}}";
+        }
+    }
+    file << "\n]}\n";
+    return written;
+}
+
+std::vector<Tracer::Latency> Tracer::latencies(){
+    std::map<std::string, std::vector<double>> durations;
+    //--- Async events of one name and frame alternate begin and end, e.g. a frame is queued in front of every node in turn
+    using AsyncKey = std::tuple<const char*, int, int>;
+    std::map<AsyncKey, std::vector<std::pair<Clock::time_point, char>>> async;
+    for (const auto& buffer : snapshot()) {
+        const std::size_t size = buffer->size.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < size; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            if (event.phase == 'X') {
+                durations[event.name].push_back(toUs(event.duration) / 1000.0);
+            } else {
+                async[AsyncKey(event.name, event.streamId, event.frameId)].emplace_back(event.begin, event.phase);
+            }
+        }
+    }
+    for (auto& frame : async) {
+        auto& events = frame.second;
+        std::sort(events.begin(), events.end());
+        for (std::size_t i = 0; i + 1 < events.size(); ++i) {
+            if (events[i].second == 'b' && events[i + 1].second == 'e') {
+                durations[std::get<0>(frame.first)].push_back(toUs(events[i + 1].first - events[i].first) / 1000.0);
+                ++i;
+            }
+        }
+    }
+
+    std::vector<Latency> result;
+    for (auto& named : durations) {
+        auto& values = named.second;
+        std::sort(values.begin(), values.end());
+        result.push_back({named.first, values.size(), percentile(values, 50), percentile(values, 90), percentile(values, 99), values.back()});
+    }
+    return result;
+}
@@ -0,0 +1,78 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-blob pipeline tracing, exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// Every thread appends to its own fixed-size buffer without locks, a full buffer drops further events.
+// Recording is a relaxed load of the enabled flag when tracing is off.
+//
+// Events of a frame carry its streamId and frameId:
+//  * span   - work on the frame in a node, e.g. process-begin to process-end, shown as a slice of the thread
+//  * begin/end - async interval of the frame, e.g. queueing between enqueue and dequeue, or an infer request
+//               from start to completion. Intervals of the same name and frame pair up across threads
+class Tracer{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Latency{
+        std::string name;
+        std::size_t count;
+        double p50Ms;
+        double p90Ms;
+        double p99Ms;
+        double maxMs;
+    };
+
+    // Allocates buffers of eventsPerThread events, lazily for each thread that records.
+    // fileName is where dump() without arguments writes
+    static void enable(const std::string& fileName, std::size_t eventsPerThread = 1 << 16);
+    // Stops recording, events recorded so far are kept
+    static void disable();
+    static bool enabled(){
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    // Names must be string literals, only the pointer is stored
+    static void span(const char* name, int streamId, int frameId, Clock::time_point begin, Clock::time_point end);
+    static void begin(const char* name, int streamId, int frameId);
+    static void end(const char* name, int streamId, int frameId);
+
+    // Drops events recorded so far, e.g. between runs of a benchmark. Only while no thread records
+    static void clear();
+
+    // Writes events recorded so far, can be called while the pipeline runs. Returns the number of events written
+    static std::size_t dump(const std::string& fileName);
+    static std::size_t dump();
+
+    // Duration percentiles of spans and of completed async intervals recorded so far, by name
+    static std::vector<Latency> latencies();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// Records a span from construction to destruction
+class TraceSpan{
+public:
+    TraceSpan(const char* name, int streamId, int frameId):
+        m_name(name), m_streamId(streamId), m_frameId(frameId), m_begin(Tracer::enabled() ? Tracer::Clock::now() : Tracer::Clock::time_point()){}
+
+    ~TraceSpan(){
+        if (Tracer::enabled()) {
+            Tracer::span(m_name, m_streamId, m_frameId, m_begin, Tracer::Clock::now());
+        }
+    }
+
+private:
+    const char* m_name;
+    int m_streamId;
+    int m_frameId;
+    Tracer::Clock::time_point m_begin;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include <TrackerNode.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+TrackerNode::TrackerNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config):
+        hva::hvaNode_t(inPortNum, outPortNum, totalThreadNum), m_cfg(config){
+
+}
+
+std::shared_ptr<hva::hvaNodeWorker_t> TrackerNode::createNodeWorker() const{
+    return std::shared_ptr<hva::hvaNodeWorker_t>(new TrackerNodeWorker((TrackerNode*)this, m_cfg));
+}
+
+TrackerNodeWorker::TrackerNodeWorker(hva::hvaNode_t* parentNode, const TrackerNode::Config& config):hva::hvaNodeWorker_t(parentNode),
+        m_cfg(config), m_solver(){
+
+}
+
+float TrackerNodeWorker::intersectionOverUnion(const cv::Rect2f& r1, const cv::Rect2f& r2){
+    const float intersection = (r1 & r2).area();
+    const float unionArea = r1.area() + r2.area() - intersection;
+    return unionArea > 0 ? intersection / unionArea : 0.f;
+}
+
+void TrackerNodeWorker::process(std::size_t batchIdx){
+    std::vector<std::shared_ptr<hva::hvaBlob_t>> vInput= hvaNodeWorker_t::getParentPtr()->getBatchedInput(batchIdx, std::vector<size_t> {0});
+    if (vInput.size() == 0) {
+        return;
+    }
+    const auto& input = vInput[0];
+    HVA_DEBUG("TrackerNode received blob with frameid %u and streamid %u", input->frameId, input->streamId);
+    Tracer::end("queue", input->streamId, input->frameId);
+    TraceSpan span("TrackerNode", input->streamId, input->frameId);
+
+    if (*input->get<int, ImageMetaData>(1)->getPtr()) {
+        Tracer::begin("queue", input->streamId, input->frameId);
+        sendOutput(input, 0, ms(0));
+        return;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto inferMeta = input->get<int, InferMeta>(0)->getMeta();
+    auto& stream = m_streams[input->streamId];
+    const int frameSteps = stream.lastFrameId < 0 ? 1 : std::max(1, input->frameId - stream.lastFrameId);
+    predict(stream, input->frameId);
+
+    if (inferMeta->detected) {
+        //--- Objects appearing or disappearing change the confirmed ids, even if their number stays the same
+        confirmedIds(stream, m_idsBefore);
+        float motion = associate(stream, inferMeta->detResult.objects, frameSteps);
+        confirmedIds(stream, m_idsAfter);
+        adaptInterval(input->streamId, motion, m_idsBefore != m_idsAfter);
+    }
+
+    //--- Frames carry confirmed tracks, and coasting ones if configured, both for detected and skipped frames
+    inferMeta->detResult.objects.clear();
+    inferMeta->trackIds.clear();
+    for (const auto& track : stream.tracks) {
+        if (track.missed == 0 || m_cfg.emitCoasting) {
+            inferMeta->detResult.objects.push_back(track.object);
+            inferMeta->trackIds.push_back(track.id);
+        }
+    }
+    m_metrics.update(startTime);
+    Tracer::begin("queue", input->streamId, input->frameId);
+    sendOutput(input, 0, ms(0));
+}
+
+void TrackerNodeWorker::predict(StreamTracks& stream, int frameId){
+    const float steps = stream.lastFrameId < 0 ? 0.f : static_cast<float>(std::max(1, frameId - stream.lastFrameId));
+    for (auto& track : stream.tracks) {
+        track.object.x += track.velocity.x * steps;
+        track.object.y += track.velocity.y * steps;
+    }
+    stream.lastFrameId = frameId;
+}
+
+void TrackerNodeWorker::confirmedIds(const StreamTracks& stream, std::vector<int>& ids){
+    //Tracks keep their order and new ones are appended with growing ids, so the ids come sorted
+    ids.clear();
+    for (const auto& track : stream.tracks) {
+        if (track.missed == 0) {
+            ids.push_back(track.id);
+        }
+    }
+}
+
+float TrackerNodeWorker::associate(StreamTracks& stream, const std::vector<DetectedObject>& detections, int frameSteps){
+    std::vector<size_t> assignment;
+    if (!stream.tracks.empty() && !detections.empty()) {
+        cv::Mat dissimilarity(static_cast<int>(stream.tracks.size()), static_cast<int>(detections.size()), CV_32F);
+        for (size_t i = 0; i < stream.tracks.size(); ++i) {
+            for (size_t j = 0; j < detections.size(); ++j) {
+                dissimilarity.at<float>(static_cast<int>(i), static_cast<int>(j)) = stream.tracks[i].object.labelID == detections[j].labelID ?
+                    1.f - intersectionOverUnion(stream.tracks[i].object, detections[j]) : 1.f;
+            }
+        }
+        assignment = m_solver.Solve(dissimilarity);
+    }
+    assignment.resize(stream.tracks.size(), static_cast<size_t>(-1));
+
+    std::vector<bool> isMatched(detections.size(), false);
+    float motion = 0.f;
+    size_t matchedNum = 0;
+    for (size_t i = 0; i < stream.tracks.size(); ++i) {
+        auto& track = stream.tracks[i];
+        const size_t j = assignment[i];
+        if (j >= detections.size() || intersectionOverUnion(track.object, detections[j]) < m_cfg.iouThreshold) {
+            track.missed++;
+            continue;
+        }
+        //--- Velocity is corrected by the error of the prediction, spread over frames since the last detection
+        const auto& detection = detections[j];
+        const cv::Point2f error = (detection.tl() + detection.br()) * 0.5f - (track.object.tl() + track.object.br()) * 0.5f;
+        track.velocity += error * (m_cfg.velocitySmoothing / frameSteps);
+        track.object = detection;
+        track.missed = 0;
+        isMatched[j] = true;
+
+        const float size = std::sqrt(std::max(detection.area(), 1.f));
+        motion += std::sqrt(track.velocity.dot(track.velocity)) / size;
+        matchedNum++;
+    }
+
+    stream.tracks.erase(std::remove_if(stream.tracks.begin(), stream.tracks.end(),
+        [this](const Track& track) { return track.missed > m_cfg.maxMissedDetections; }), stream.tracks.end());
+    for (size_t j = 0; j < detections.size(); ++j) {
+        if (!isMatched[j]) {
+            stream.tracks.push_back(Track{stream.nextTrackId++, detections[j], cv::Point2f(0.f, 0.f), 0});
+        }
+    }
+    return matchedNum ? motion / matchedNum : 0.f;
+}
+
+void TrackerNodeWorker::adaptInterval(int streamId, float motion, bool tracksChanged){
+    if (!m_cfg.scheduler || !m_cfg.scheduler->isAdaptive()) {
+        return;
+    }
+    //--- Fast motion or appearing/disappearing objects halve the interval, a calm scene extends it by one frame
+    unsigned interval = m_cfg.scheduler->interval(streamId);
+    if (motion > m_cfg.motionThreshold || tracksChanged) {
+        interval = std::max(1u, interval / 2);
+    } else {
+        interval++;
+    }
+    m_cfg.scheduler->setInterval(streamId, interval);
+}
+
+void TrackerNodeWorker::init(){
+}
+
+void TrackerNodeWorker::deinit(){
+}
+
+void TrackerNodeWorker::processByFirstRun(std::size_t batchIdx) {
+}
+
+void TrackerNodeWorker::processByLastRun(std::size_t batchIdx) {
+    slog::info << "Tracking" << slog::endl;
+    slog::info << "\tLatency:\t" << std::fixed << std::setprecision(1) << m_metrics.getTotal().latency << " ms" << slog::endl;
+    if (!m_cfg.scheduler) {
+        return;
+    }
+    for (const auto& stream : m_streams) {
+        auto counters = m_cfg.scheduler->counters(stream.first);
+        const uint64_t total = counters.detected + counters.skipped;
+        slog::info << "\tStream #" << stream.first << ":\t" << counters.detected << " of " << total <<
+            " frames detected, interval " << m_cfg.scheduler->interval(stream.first) << slog::endl;
+    }
+}
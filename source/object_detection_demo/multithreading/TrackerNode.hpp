@@ -0,0 +1,88 @@
+#ifndef TRACKER_NODE_HPP
+#define TRACKER_NODE_HPP
+
+#include <thread>
+#include <iostream>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <inc/api/hvaPipeline.hpp>
+
+#include <opencv2/core.hpp>
+
+#include <utils/kuhn_munkres.hpp>
+#include <utils/performance_metrics.hpp>
+
+#include <OdInferNode.hpp>
+#include <DetectionScheduler.hpp>
+#include <Tracer.hpp>
+
+using ms = std::chrono::milliseconds;
+
+// Associates detections across frames of every stream and fills frames skipped by
+// ODInferNode with predicted tracks. Expects frames of each stream in order
+// (ODInferNode::Config::keepStreamOrder).
+// Frames carry confirmed tracks, matched by the last detection. A track which missed a detection
+// coasts on its prediction until it is matched again or dropped, and is only sent with emitCoasting.
+class TrackerNode : public hva::hvaNode_t{
+public:
+    struct Config{
+        float iouThreshold = 0.3f;  //Minimal IoU of a predicted track and a detection to associate them
+        unsigned maxMissedDetections = 3;  //Track is dropped after this many detected frames without a match
+        float velocitySmoothing = 0.5f;  //Weight of the newly measured velocity, 1 keeps only the last measurement
+        bool emitCoasting = false;  //Frames also carry coasting tracks, which missed detections but are not dropped yet
+        float motionThreshold = 0.02f;  //Motion per frame, relative to box size, above which the detection interval shrinks
+        std::shared_ptr<DetectionScheduler> scheduler = nullptr;  //Optional. Adapted by the tracker if its interval is not fixed
+    };
+
+    TrackerNode(std::size_t inPortNum, std::size_t outPortNum, std::size_t totalThreadNum, const Config& config);
+
+    virtual std::shared_ptr<hva::hvaNodeWorker_t> createNodeWorker() const override;
+
+private:
+    Config m_cfg;
+};
+
+class TrackerNodeWorker : public hva::hvaNodeWorker_t{
+public:
+    TrackerNodeWorker(hva::hvaNode_t* parentNode, const TrackerNode::Config& config);
+
+    virtual void process(std::size_t batchIdx) override;
+    virtual void init() override;
+    virtual void deinit() override;
+
+    virtual void processByFirstRun(std::size_t batchIdx) override;
+    virtual void processByLastRun(std::size_t batchIdx) override;
+
+private:
+    struct Track{
+        int id;
+        DetectedObject object;  //Last predicted or matched box
+        cv::Point2f velocity;  //Center motion per frame
+        unsigned missed;  //Detected frames in a row without a match
+    };
+
+    struct StreamTracks{
+        std::vector<Track> tracks;
+        int nextTrackId = 0;
+        int lastFrameId = -1;
+    };
+
+    void predict(StreamTracks& stream, int frameId);
+    // Returns mean motion of matched tracks per frame, relative to their size
+    float associate(StreamTracks& stream, const std::vector<DetectedObject>& detections, int frameSteps);
+    void adaptInterval(int streamId, float motion, bool tracksChanged);
+    // Ids of tracks matched by the last detection, in ascending order
+    static void confirmedIds(const StreamTracks& stream, std::vector<int>& ids);
+    static float intersectionOverUnion(const cv::Rect2f& r1, const cv::Rect2f& r2);
+
+    TrackerNode::Config m_cfg;
+    KuhnMunkres m_solver;
+    std::map<int, StreamTracks> m_streams;  //Keyed by streamId
+    std::vector<int> m_idsBefore;  //Confirmed track ids before and after association, reused across frames
+    std::vector<int> m_idsAfter;
+    PerformanceMetrics m_metrics;
+};
+#endif
@@ -0,0 +1,282 @@
+// Headless benchmark of the detection pipeline: synthetic source -> ODInferNode -> null sink.
+// Needs no input files, so framework overhead can be compared across builds on any machine.
+// Reports throughput, latency percentiles of every node and queue from the trace, CPU
+// utilization of the process and heap allocations per frame.
+// With a mock delay inference is mocked, see MockModel, so the maximum FPS of the pipeline itself can be
+// measured without the target device.
+// Options taking a comma separated list run the pipeline once per value and compare the runs.
+
+#include <FrameReaderNode.hpp>
+#include <OdInferNode.hpp>
+#include <SinkNode.hpp>
+#include <AllocationCounter.hpp>
+#include <Tracer.hpp>
+#include <utils/args_helper.hpp>
+
+#include <gflags/gflags.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char help_message[] = "Print a usage message.";
+static const char model_message[] = "Required. Path to an .xml file with a YOLO model.";
+static const char streams_message[] = "Optional. Number of synthetic streams.";
+static const char frames_message[] = "Optional. Number of frames of every stream.";
+static const char resolution_message[] = "Optional. Resolution of synthetic frames, <width>x<height>.";
+static const char bs_message[] = "Optional. Batch size of ODInferNode. A comma separated list, e.g. 1,2,4,8, "
+                                 "runs every batch size in turn and compares the runs.";
+static const char ingraph_pp_message[] = "Optional. 1 decodes boxes and runs NMS inside the compiled model, 0 in C++ "
+                                         "postprocessing. 0,1 runs both and compares the runs.";
+static const char mock_delay_message[] = "Optional. Mock inference with the given delay: <ms>, uniform:<min>:<max>, "
+                                         "normal:<mean>:<stddev> or exponential:<mean>.";
+static const char mock_outputs_message[] = "Optional. File with raw outputs returned by mocked inference, zeros by default.";
+static const char nv12_message[] = "Optional. Generate NV12 frames, converted to BGR inside the model.";
+static const char tracing_message[] = "Optional. 1 traces every frame, 0 runs without tracing and without latencies. "
+                                      "1,0 runs both and compares the runs, which measures the overhead of tracing.";
+static const char trace_message[] = "Optional. File to write the trace of the last traced run to.";
+
+DEFINE_bool(h, false, help_message);
+DEFINE_string(m, "", model_message);
+DEFINE_uint32(streams, 4, streams_message);
+DEFINE_uint32(frames, 1000, frames_message);
+DEFINE_string(resolution, "1280x720", resolution_message);
+DEFINE_string(bs, "1", bs_message);
+DEFINE_string(ingraph_pp, "0", ingraph_pp_message);
+DEFINE_string(mock_delay, "", mock_delay_message);
+DEFINE_string(mock_outputs, "", mock_outputs_message);
+DEFINE_bool(nv12, false, nv12_message);
+DEFINE_string(tracing, "1", tracing_message);
+DEFINE_string(trace, "", trace_message);
+
+namespace {
+void showUsage(){
+    std::cout << std::endl;
+    std::cout << "pipeline_benchmark [OPTION]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -h                        " << help_message << std::endl;
+    std::cout << "    -m \"<path>\"               " << model_message << std::endl;
+    std::cout << "    -streams \"<integer>\"      " << streams_message << std::endl;
+    std::cout << "    -frames \"<integer>\"       " << frames_message << std::endl;
+    std::cout << "    -resolution               " << resolution_message << std::endl;
+    std::cout << "    -bs \"<list>\"              " << bs_message << std::endl;
+    std::cout << "    -ingraph_pp \"<list>\"      " << ingraph_pp_message << std::endl;
+    std::cout << "    -mock_delay               " << mock_delay_message << std::endl;
+    std::cout << "    -mock_outputs \"<path>\"    " << mock_outputs_message << std::endl;
+    std::cout << "    -nv12                     " << nv12_message << std::endl;
+    std::cout << "    -tracing \"<list>\"         " << tracing_message << std::endl;
+    std::cout << "    -trace \"<path>\"           " << trace_message << std::endl;
+}
+
+// User and system CPU time of all threads of the process
+double processCpuSeconds(){
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+    auto seconds = [](const FILETIME& time) {
+        return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 1e7;
+    };
+    return seconds(kernel) + seconds(user);
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+}
+
+// Parameters varied across the runs of one invocation
+struct RunConfig{
+    std::size_t batchSize;
+    bool ingraphPp;
+    bool tracing;
+};
+
+// Summary of a run for the comparison of runs
+struct RunResult{
+    RunConfig config;
+    double fps;
+    double cpuMsPerFrame;
+    double allocationsPerFrame;
+    double inferP50Ms;
+    double inferP99Ms;
+    double postprocessP50Ms;
+};
+
+std::string describe(const RunConfig& config){
+    return "batch size " + std::to_string(config.batchSize) + (config.ingraphPp ? ", in-graph pp" : ", C++ pp") +
+        (config.tracing ? ", traced" : ", not traced");
+}
+
+RunResult runPipeline(const RunConfig& config){
+    const std::size_t streamNum = FLAGS_streams;
+    const std::size_t frameNum = FLAGS_frames;
+
+    //Latencies are reported per run, the trace file gets the last traced run.
+    //Room for every event of a run, the detection thread records several events per frame of every stream
+    if (config.tracing) {
+        Tracer::clear();
+        Tracer::enable(FLAGS_trace, std::max<std::size_t>(1 << 16, 8 * streamNum * frameNum));
+    } else {
+        Tracer::disable();
+    }
+
+    hva::hvaPipeline_t pl;
+    pl.registerEvent(hvaEvent_EOF);
+
+    //Source node, unpaced synthetic frames ending after frameNum frames of every stream
+    FrameReaderNode::Config FRConfig;
+    FRConfig.inputs.assign(streamNum, "synthetic:" + FLAGS_resolution + ":bars:" + std::to_string(frameNum));
+    FRConfig.infiniteLoop = false;
+    FRConfig.readType = read_type::safe;
+    FRConfig.maxDepth = 16;
+    //Synthetic frames are generated as NV12, so the model converts them as frames of a decoder which outputs NV12
+    FRConfig.nv12 = FLAGS_nv12;
+
+    hva::hvaBatchingConfig_t batchingConfig;
+    batchingConfig.batchingPolicy = hva::hvaBatchingConfig_t::BatchingWithStream;
+    batchingConfig.batchSize = 1;
+    batchingConfig.streamNum = streamNum;
+    batchingConfig.threadNumPerBatch = 1;
+
+    auto& FRNode = pl.setSource(std::make_shared<FrameReaderNode>(0, 1, streamNum, FRConfig), "FRNode");
+    FRNode.configBatch(batchingConfig);
+
+    hva::hvaBatchingConfig_t detectionBatchingConfig;
+    detectionBatchingConfig.batchingPolicy = hva::hvaBatchingConfig_t::BatchingIgnoringStream;
+    detectionBatchingConfig.batchSize = config.batchSize;
+    detectionBatchingConfig.streamNum = 1;
+    detectionBatchingConfig.threadNumPerBatch = 1;
+
+    hva::hvaBatchingConfig_t mergedBatchingConfig;
+    mergedBatchingConfig.batchingPolicy = hva::hvaBatchingConfig_t::BatchingIgnoringStream;
+    mergedBatchingConfig.batchSize = 1;
+    mergedBatchingConfig.streamNum = 1;
+    mergedBatchingConfig.threadNumPerBatch = 1;
+
+    ODInferNode::Config ODConfig;
+    ODConfig.modelFileName = FLAGS_m;
+    ODConfig.architectureType = "yolo";
+    ODConfig.nstreams = "1";
+    ODConfig.batchSize = config.batchSize;
+    ODConfig.yolo_ingraph_pp = config.ingraphPp;
+    ODConfig.nv12Input = FRConfig.nv12;
+    ODConfig.poolSize = streamNum * FRConfig.maxDepth;
+    ODConfig.nireq = static_cast<uint32_t>(std::max<std::size_t>(4, 2 * config.batchSize));
+    ODConfig.mockDelay = FLAGS_mock_delay;
+    ODConfig.mockOutputsFile = FLAGS_mock_outputs;
+    auto& OdNode = pl.addNode(std::make_shared<ODInferNode>(1, 1, 1, ODConfig), "OdNode");
+    OdNode.configBatch(detectionBatchingConfig);
+
+    auto& SNode = pl.addNode(std::make_shared<SinkNode>(1, 0, 1, SinkNode::parseConfig("null")), "SinkNode");
+    SNode.configBatch(mergedBatchingConfig);
+
+    pl.linkNode("FRNode", 0, "OdNode", 0);
+    pl.linkNode("OdNode", 0, "SinkNode", 0);
+
+    pl.prepare();
+
+    const uint64_t allocationsBefore = totalAllocationCount();
+    const double cpuBefore = processCpuSeconds();
+    const auto startTime = std::chrono::steady_clock::now();
+    pl.start();
+
+    //block here until EOF event is received, i.e. all streams ended
+    pl.waitForEvent(hvaEvent_EOF);
+
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - startTime;
+    const double cpu = processCpuSeconds() - cpuBefore;
+    const uint64_t allocations = totalAllocationCount() - allocationsBefore;
+
+    pl.stop();
+
+    //--- Whole run including warm-up, from start to the release of the last frame
+    const std::size_t totalFrames = streamNum * frameNum;
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    RunResult result {config, totalFrames / wall.count(), 1000.0 * cpu / totalFrames,
+        static_cast<double>(allocations) / totalFrames, 0.0, 0.0, 0.0};
+    slog::info << "Pipeline benchmark (" << streamNum << " x " << frameNum << " frames of " << FLAGS_resolution <<
+        ", " << describe(config) << (FLAGS_mock_delay.empty() ? "" : ", mock delay " + FLAGS_mock_delay) << ")" << slog::endl;
+    slog::info << "\tThroughput:\t" << std::fixed << std::setprecision(1) << result.fps << " FPS" << slog::endl;
+    slog::info << "\tCPU:\t" << 100.0 * cpu / wall.count() << "% of a core, " << 100.0 * cpu / wall.count() / cores <<
+        "% of " << cores << " cores, " << result.cpuMsPerFrame << " ms per frame" << slog::endl;
+    slog::info << "\tAllocations:\t" << allocations << " total, " << result.allocationsPerFrame << " per frame" << slog::endl;
+    if (!config.tracing) {
+        return result;
+    }
+    slog::info << "\tLatency, ms\tcount\tp50\tp90\tp99\tmax" << slog::endl;
+    for (const auto& latency : Tracer::latencies()) {
+        slog::info << "\t" << latency.name << "\t" << latency.count << "\t" << std::setprecision(2) << latency.p50Ms << "\t" <<
+            latency.p90Ms << "\t" << latency.p99Ms << "\t" << latency.maxMs << slog::endl;
+        if (latency.name == "infer") {
+            result.inferP50Ms = latency.p50Ms;
+            result.inferP99Ms = latency.p99Ms;
+        } else if (latency.name == "ODInferNode.postprocess") {
+            result.postprocessP50Ms = latency.p50Ms;
+        }
+    }
+    return result;
+}
+}  // namespace
+
+int main(int argc, char* argv[]){
+    hvaLogger.setLogLevel(hva::hvaLogger_t::LogLevel::WARNING);
+
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showUsage();
+        return 0;
+    }
+    if (FLAGS_m.empty()) {
+        throw std::logic_error("Parameter -m is not set");
+    }
+
+    std::vector<RunConfig> runs;
+    for (const auto& batchSize : split(FLAGS_bs, ',')) {
+        for (const auto& ingraphPp : split(FLAGS_ingraph_pp, ',')) {
+            for (const auto& tracing : split(FLAGS_tracing, ',')) {
+                runs.push_back({std::stoul(batchSize), ingraphPp != "0", tracing != "0"});
+            }
+        }
+    }
+    //--- NMS outputs have dynamic shapes, which mock inference can't produce
+    if (!FLAGS_mock_delay.empty() && std::any_of(runs.begin(), runs.end(), [](const RunConfig& run) { return run.ingraphPp; })) {
+        throw std::invalid_argument("-ingraph_pp 1 needs the real model, -mock_delay can't mock dynamic shapes of NMS outputs");
+    }
+
+    std::vector<RunResult> results;
+    for (const auto& run : runs) {
+        results.push_back(runPipeline(run));
+    }
+
+    if (!FLAGS_trace.empty() && std::any_of(runs.begin(), runs.end(), [](const RunConfig& run) { return run.tracing; })) {
+        slog::info << "Trace of " << Tracer::dump() << " events is written to " << FLAGS_trace << slog::endl;
+    }
+
+    //--- Runs side by side, throughput relative to the first run
+    if (results.size() > 1) {
+        slog::info << "Comparison of runs" << slog::endl;
+        slog::info << "\tRun\tFPS\tspeedup\tCPU ms/frame\tallocations/frame\tinfer p50, ms\tinfer p99, ms\tpostprocess p50, ms" << slog::endl;
+        for (const auto& result : results) {
+            slog::info << "\t" << describe(result.config) << "\t" << std::fixed << std::setprecision(1) << result.fps << "\t" <<
+                std::setprecision(2) << result.fps / results.front().fps << "x\t" << result.cpuMsPerFrame << "\t" <<
+                result.allocationsPerFrame << "\t" << result.inferP50Ms << "\t" << result.inferP99Ms << "\t" << result.postprocessP50Ms << slog::endl;
+        }
+    }
+    return 0;
+}
@@ -1,17 +1,37 @@
 #ifndef COMMON_HPP
 #define COMMON_HPP
 
+#include <vector>
+
 struct InferMeta{
     int totalROI;           //Total ROI number
     int frameId;            //Frame id
     DetectionResult    detResult;
+    bool detected;          //False if detection was skipped for the frame, detResult is then filled by TrackerNode
+    std::vector<int> trackIds;  //Track id of every detResult object, filled by TrackerNode
     float inferFps;         //Inference FPS
 
     int cntDetection;       //Detection count
     int cntClassification;  //Classification count
     float detectionFps;     //detection FPS
     float classificationFps;//classification FPS
-    InferMeta():totalROI(0),frameId(0),inferFps(0.0),cntDetection(0),cntClassification(0),detectionFps(0.0),classificationFps(0.0) {}
+    InferMeta():totalROI(0),frameId(0),detected(true),inferFps(0.0),cntDetection(0),cntClassification(0),detectionFps(0.0),classificationFps(0.0) {}
+
+    //Restores the state of a new InferMeta for reuse, keeping the capacity of its vectors
+    void reset(){
+        totalROI = 0;
+        frameId = 0;
+        detResult.frameId = -1;
+        detResult.metaData.reset();
+        detResult.objects.clear();
+        detected = true;
+        trackIds.clear();
+        inferFps = 0.0;
+        cntDetection = 0;
+        cntClassification = 0;
+        detectionFps = 0.0;
+        classificationFps = 0.0;
+    }
 };
 
 #endif
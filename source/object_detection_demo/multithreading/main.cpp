@@ -1,59 +1,275 @@
 #include <FrameReaderNode.hpp>
+#include <DecimationNode.hpp>
 #include <OdInferNode.hpp>
 #include <DisplayNode.hpp>
-#include <Windows.h>
+#include <SinkNode.hpp>
+#include <TrackerNode.hpp>
+#include <ClassificationNode.hpp>
+#include <Tracer.hpp>
+#include <AllocationCounter.hpp>
+#include <utils/args_helper.hpp>
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+static const char help_message[] = "Print a usage message.";
+static const char input_message[] = "Optional. Comma separated list of videos, image folders, camera ids or "
+                                    "synthetic:<width>x<height>[@<fps>][:<pattern>[:<frames>]] inputs, one stream per input.";
+static const char model_message[] = "Optional. Path to a YOLO model (.xml).";
+static const char bs_message[] = "Optional. Number of frames ODInferNode takes from one HVA batch.";
+static const char sink_message[] = "Optional. Where results go: display, null, json:<file>, binary:<file> or video:<file>.";
+static const char interval_message[] = "Optional. Detection interval, N detects every N-th frame of each stream, N-M adapts "
+                                       "the interval between N and M. Other frames are tracked. 0 disables tracking.";
+static const char emit_coasting_message[] = "Optional. Frames also carry tracks which missed detections but are not dropped yet.";
+static const char cls_m_message[] = "Optional. Path to a classification model (.xml), objects are classified if it is set.";
+static const char cls_labels_message[] = "Optional. Path to the label file of the classification model.";
+static const char target_latency_message[] = "Optional. End-to-end latency in ms DecimationNode holds by dropping frames. "
+                                             "0 keeps every frame.";
+static const char cache_mb_message[] = "Optional. Looped inputs are decoded once and kept in memory, up to the given MB per stream.";
+static const char decode_size_message[] = "Optional. Inputs larger than the given <width>x<height>, e.g. the network input, "
+                                          "are decoded reduced.";
+static const char nv12_message[] = "Optional. Frames stay NV12 up to the model, which converts them.";
+static const char segments_message[] = "Optional. Splits a single video input at keyframes into up to the given number of "
+                                       "segments decoded in parallel. Needs a json or binary sink.";
+static const char trace_message[] = "Optional. File to write the trace of every frame to, on exit or on 't' key of the display.";
+static const char record_outputs_message[] = "Optional. File to write raw outputs of the first frame to, for mock inference "
+                                             "of pipeline_benchmark.";
+
+DEFINE_bool(h, false, help_message);
+DEFINE_string(i, "C:/work/sample-videos/car-detection.mp4", input_message);
+DEFINE_string(m, "C:/work/yolo-v2-tiny/FP16-INT8/yolo-v2-tiny-ava-0001.xml", model_message);
+DEFINE_uint32(bs, 1, bs_message);
+DEFINE_string(sink, "display", sink_message);
+DEFINE_string(interval, "0", interval_message);
+DEFINE_bool(emit_coasting, false, emit_coasting_message);
+DEFINE_string(cls_m, "", cls_m_message);
+DEFINE_string(cls_labels, "", cls_labels_message);
+DEFINE_double(target_latency, 0, target_latency_message);
+DEFINE_uint32(cache_mb, 0, cache_mb_message);
+DEFINE_string(decode_size, "", decode_size_message);
+DEFINE_bool(nv12, false, nv12_message);
+DEFINE_uint32(segments, 0, segments_message);
+DEFINE_string(trace, "", trace_message);
+DEFINE_string(record_outputs, "", record_outputs_message);
+
+static void showUsage(){
+    std::cout << std::endl;
+    std::cout << "multi_threading_object_detection_demo [OPTION]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << std::endl;
+    std::cout << "    -h                        " << help_message << std::endl;
+    std::cout << "    -i \"<inputs>\"             " << input_message << std::endl;
+    std::cout << "    -m \"<path>\"               " << model_message << std::endl;
+    std::cout << "    -bs \"<integer>\"           " << bs_message << std::endl;
+    std::cout << "    -sink \"<sink>\"            " << sink_message << std::endl;
+    std::cout << "    -interval \"<N[-M]>\"       " << interval_message << std::endl;
+    std::cout << "    -emit_coasting            " << emit_coasting_message << std::endl;
+    std::cout << "    -cls_m \"<path>\"           " << cls_m_message << std::endl;
+    std::cout << "    -cls_labels \"<path>\"      " << cls_labels_message << std::endl;
+    std::cout << "    -target_latency           " << target_latency_message << std::endl;
+    std::cout << "    -cache_mb \"<integer>\"     " << cache_mb_message << std::endl;
+    std::cout << "    -decode_size              " << decode_size_message << std::endl;
+    std::cout << "    -nv12                     " << nv12_message << std::endl;
+    std::cout << "    -segments \"<integer>\"     " << segments_message << std::endl;
+    std::cout << "    -trace \"<path>\"           " << trace_message << std::endl;
+    std::cout << "    -record_outputs \"<path>\"  " << record_outputs_message << std::endl;
+}
 
 int main(int argc, char* argv[]){
     hvaLogger.setLogLevel(hva::hvaLogger_t::LogLevel::WARNING);
 
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showUsage();
+        return 0;
+    }
+    if (!FLAGS_cls_m.empty() && FLAGS_cls_labels.empty()) {
+        throw std::logic_error("Parameter -cls_labels is not set");
+    }
+
     HVA_INFO("App Start:");
 
+    //Tracing is enabled by the trace file name, the trace is written on exit or on 't' key of the display
+    if (!FLAGS_trace.empty()) {
+        Tracer::enable(FLAGS_trace);
+    }
+
     hva::hvaPipeline_t pl;
     pl.registerEvent(hvaEvent_EOF);
 
+    //Source node, one decoding worker per comma separated input
+    FrameReaderNode::Config FRConfig;
+    FRConfig.inputs = split(FLAGS_i, ',');
+    FRConfig.infiniteLoop = true;
+    FRConfig.readType = read_type::safe;
+    FRConfig.maxDepth = 16;
+    //Looped inputs are decoded once and kept in memory, up to the given MB per stream
+    FRConfig.cacheLimitMb = FLAGS_cache_mb;
+    //Inputs larger than the given <width>x<height>, e.g. the network input, are decoded reduced
+    if (!FLAGS_decode_size.empty()) {
+        const auto size = split(FLAGS_decode_size, 'x');
+        FRConfig.decodeSize = cv::Size(std::stoi(size.at(0)), std::stoi(size.at(1)));
+    }
+    //Frames stay NV12 up to the model, which converts them, only rendered frames are converted on the CPU
+    FRConfig.nv12 = FLAGS_nv12;
+    //Offline mode, one video is split at keyframes into segments decoded in parallel as streams of their own
+    std::vector<std::size_t> segmentFirstFrames;
+    if (FLAGS_segments > 0) {
+        if (FRConfig.inputs.size() != 1) {
+            throw std::invalid_argument("-segments needs a single video input");
+        }
+        if (FLAGS_sink.compare(0, 6, "video:") == 0) {
+            throw std::invalid_argument("-segments needs a json or binary sink, the video sink would write a file per segment");
+        }
+        FRConfig.segments = splitVideo(FRConfig.inputs[0], FLAGS_segments);
+        FRConfig.inputs.assign(FRConfig.segments.size(), FRConfig.inputs[0]);
+        FRConfig.infiniteLoop = false;
+        for (const auto& segment : FRConfig.segments) {
+            segmentFirstFrames.push_back(segment.firstFrame);
+        }
+        slog::info << "Video is split into " << FRConfig.segments.size() << " segments" << slog::endl;
+    }
+    const std::size_t streamNum = FRConfig.inputs.size();
+
     hva::hvaBatchingConfig_t batchingConfig;
     batchingConfig.batchingPolicy = hva::hvaBatchingConfig_t::BatchingWithStream;
     batchingConfig.batchSize = 1;
-    batchingConfig.streamNum = 1;
+    batchingConfig.streamNum = streamNum;
     batchingConfig.threadNumPerBatch = 1;
 
-    //Source node
-    FrameReaderNode::Config FRConfig;
-    FRConfig.input = "C:/work/sample-videos/car-detection.mp4";
-    FRConfig.infiniteLoop = true;
-    FRConfig.readType = read_type::safe;
-    auto& FRNode = pl.setSource(std::make_shared<FrameReaderNode>(0, 1, 1, FRConfig), "FRNode");
+    auto& FRNode = pl.setSource(std::make_shared<FrameReaderNode>(0, 1, streamNum, FRConfig), "FRNode");
     FRNode.configBatch(batchingConfig);
 
+    //Detection batches blobs across streams, so a batch may hold frames of several streams
+    const std::size_t batchSize = FLAGS_bs;
+    hva::hvaBatchingConfig_t detectionBatchingConfig;
+    detectionBatchingConfig.batchingPolicy = hva::hvaBatchingConfig_t::BatchingIgnoringStream;
+    detectionBatchingConfig.batchSize = batchSize;
+    detectionBatchingConfig.streamNum = 1;
+    detectionBatchingConfig.threadNumPerBatch = 1;
+
+    //Downstream nodes run a single worker which takes blobs of all streams
+    hva::hvaBatchingConfig_t mergedBatchingConfig;
+    mergedBatchingConfig.batchingPolicy = hva::hvaBatchingConfig_t::BatchingIgnoringStream;
+    mergedBatchingConfig.batchSize = 1;
+    mergedBatchingConfig.streamNum = 1;
+    mergedBatchingConfig.threadNumPerBatch = 1;
+
+    //Told of every completed frame by the sink, read by DecimationNode and by the allocation report on exit
+    auto latencyMonitor = std::make_shared<LatencyMonitor>();
+
+    //Decimation node, only if target latency is set
+    const bool decimate = FLAGS_target_latency > 0;
+    if (decimate) {
+        DecimationNode::Config RateConfig;
+        RateConfig.monitor = latencyMonitor;
+        RateConfig.targetLatencyMs = FLAGS_target_latency;
+        auto& RateNode = pl.addNode(std::make_shared<DecimationNode>(1, 1, 1, RateConfig), "RateNode");
+        RateNode.configBatch(mergedBatchingConfig);
+    }
+
     //Detection node
     ODInferNode::Config ODConfig;
-    ODConfig.modelFileName = "C:/work/yolo-v2-tiny/FP16-INT8/yolo-v2-tiny-ava-0001.xml";
+    ODConfig.modelFileName = FLAGS_m;
     ODConfig.architectureType = "yolo";
     ODConfig.nstreams = "1";
-    ODConfig.nireq = 4;
+    ODConfig.batchSize = batchSize;
+    ODConfig.nv12Input = FRConfig.nv12;
+    ODConfig.poolSize = FRConfig.inputs.size() * FRConfig.maxDepth;  //Every frame admitted by FrameReaderNode may be in flight downstream
+    //Detection interval "N" detects every N-th frame, "N-M" adapts the interval between N and M. Other frames are tracked. "0" disables tracking
+    std::shared_ptr<DetectionScheduler> scheduler;
+    if (FLAGS_interval != "0") {
+        const auto interval = split(FLAGS_interval, '-');
+        const unsigned minInterval = static_cast<unsigned>(std::stoul(interval[0]));
+        const unsigned maxInterval = interval.size() > 1 ? static_cast<unsigned>(std::stoul(interval[1])) : minInterval;
+        scheduler = std::make_shared<DetectionScheduler>(minInterval, maxInterval);
+    }
+    ODConfig.scheduler = scheduler;
+    ODConfig.nireq = static_cast<uint32_t>(std::max<std::size_t>(4, 2 * batchSize));  //Next batch is submitted while the previous one is inferred
+    //Raw outputs of the first frame are recorded for mock inference of pipeline_benchmark
+    ODConfig.recordOutputsFile = FLAGS_record_outputs;
     auto& OdNode = pl.addNode(std::make_shared<ODInferNode>(1, 1, 1, ODConfig), "OdNode");
-    OdNode.configBatch(batchingConfig);
+    OdNode.configBatch(detectionBatchingConfig);
+
+    //Tracker node, only if detection interval is set
+    std::string sinkParent = "OdNode";
+    if (scheduler) {
+        TrackerNode::Config TrackerConfig;
+        TrackerConfig.scheduler = scheduler;
+        TrackerConfig.emitCoasting = FLAGS_emit_coasting;
+        auto& TrackNode = pl.addNode(std::make_shared<TrackerNode>(1, 1, 1, TrackerConfig), "TrackNode");
+        TrackNode.configBatch(mergedBatchingConfig);
+        sinkParent = "TrackNode";
+    }
+
+    //Classification node, only if classification model is set
+    const bool classify = !FLAGS_cls_m.empty();
+    if (classify) {
+        ClassificationNode::Config ClsConfig;
+        ClsConfig.modelFileName = FLAGS_cls_m;
+        ClsConfig.labelFilename = FLAGS_cls_labels;
+        ClsConfig.nireq = 8;  //Crops of one frame are classified in parallel
+        auto& ClsNode = pl.addNode(std::make_shared<ClassificationNode>(1, 1, 1, ClsConfig), "ClsNode");
+        ClsNode.configBatch(mergedBatchingConfig);
+    }
 
-    //Sink node
-    DisplayNode::Config DispConfig;
-    auto& DispNode = pl.addNode(std::make_shared<DisplayNode>(1, 0, 1, DispConfig), "DispNode");
-    DispNode.configBatch(batchingConfig);
+    //Sink node, display window or one of headless sinks
+    const std::string& sink = FLAGS_sink;
+    if (sink == "display") {
+        DisplayNode::Config DispConfig;
+        DispConfig.latencyMonitor = latencyMonitor;
+        auto& DispNode = pl.addNode(std::make_shared<DisplayNode>(1, 0, 1, DispConfig), "SinkNode");
+        DispNode.configBatch(mergedBatchingConfig);
+    } else {
+        SinkNode::Config SConfig = SinkNode::parseConfig(sink);
+        SConfig.latencyMonitor = latencyMonitor;
+        SConfig.segmentFirstFrames = segmentFirstFrames;
+        auto& SNode = pl.addNode(std::make_shared<SinkNode>(1, 0, 1, SConfig), "SinkNode");
+        SNode.configBatch(mergedBatchingConfig);
+    }
 
     // Link nodes
-    pl.linkNode("FRNode", 0, "OdNode", 0);
-    pl.linkNode("OdNode", 0, "DispNode", 0);
+    if (decimate) {
+        pl.linkNode("FRNode", 0, "RateNode", 0);
+        pl.linkNode("RateNode", 0, "OdNode", 0);
+    } else {
+        pl.linkNode("FRNode", 0, "OdNode", 0);
+    }
+    if (scheduler) {
+        pl.linkNode("OdNode", 0, "TrackNode", 0);
+    }
+    if (classify) {
+        pl.linkNode(sinkParent, 0, "ClsNode", 0);
+        sinkParent = "ClsNode";
+    }
+    pl.linkNode(sinkParent, 0, "SinkNode", 0);
 
     // Start pipeline
     pl.prepare();
 
     std::cout<<"\nPipeline Start: "<<std::endl;
+    const uint64_t allocationsBefore = totalAllocationCount();
     pl.start();
 
-    //block here until EOF event is received
+    //block here until EOF event is received, i.e. all streams ended
     pl.waitForEvent(hvaEvent_EOF);
 
     pl.stop();
 
+    //--- Heap allocations of all threads, not only of the pooled blob building counted by the nodes
+    const uint64_t allocations = totalAllocationCount() - allocationsBefore;
+    const uint64_t completed = latencyMonitor->snapshot().completed;
+    slog::info << "Pipeline allocations:\t" << allocations << " total, " <<
+        (completed ? static_cast<double>(allocations) / completed : 0.0) << " per completed frame" << slog::endl;
+
+    if (Tracer::enabled()) {
+        slog::info << "Trace of " << Tracer::dump() << " events is written to " << FLAGS_trace << slog::endl;
+    }
+
     HVA_INFO("App terminate");
     return 0;
 }
@@ -0,0 +1,94 @@
+// Contention benchmark of hvaThreadSafeQueue_t against hvaLockFreeQueue_t.
+// Producers and consumers pass shared pointers, as HVA ports pass blobs, through a small
+// bounded queue with blocking push and pop.
+//
+// Usage: queueBenchmark [<items per run>] [<queue size>] [<threads per side for N:N>]
+
+#include <inc/util/hvaLockFreeQueue.hpp>
+#include <inc/util/hvaThreadSafeQueue.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Item = std::shared_ptr<int>;
+
+template <typename Queue>
+double runOnce(std::size_t producers, std::size_t consumers, std::size_t items, std::size_t queueSize){
+    Queue queue(queueSize);
+    const Item payload = std::make_shared<int>(0);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&queue]() {
+            Item item;
+            //--- Empty item is the end marker, one per consumer
+            while (queue.pop(item) && item) {
+            }
+        });
+    }
+    std::vector<std::thread> producerThreads;
+    for (std::size_t p = 0; p < producers; ++p) {
+        const std::size_t count = items / producers + (p < items % producers ? 1 : 0);
+        producerThreads.emplace_back([&queue, &payload, count]() {
+            for (std::size_t i = 0; i < count; ++i) {
+                queue.push(payload);
+            }
+        });
+    }
+    for (auto& thread : producerThreads) {
+        thread.join();
+    }
+    for (std::size_t c = 0; c < consumers; ++c) {
+        queue.push(Item());
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return items / elapsed.count() / 1e6;
+}
+
+// Median of several runs, in millions of items per second
+template <typename Queue>
+double run(std::size_t producers, std::size_t consumers, std::size_t items, std::size_t queueSize){
+    std::vector<double> results;
+    for (int i = 0; i < 5; ++i) {
+        results.push_back(runOnce<Queue>(producers, consumers, items, queueSize));
+    }
+    std::sort(results.begin(), results.end());
+    return results[results.size() / 2];
+}
+
+int main(int argc, char* argv[]){
+    const std::size_t items = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const std::size_t queueSize = argc > 2 ? std::stoul(argv[2]) : 64;
+    const std::size_t n = argc > 3 ? std::stoul(argv[3]) : std::max(2u, std::thread::hardware_concurrency() / 2);
+
+    struct Setup {
+        std::string name;
+        std::size_t producers;
+        std::size_t consumers;
+    };
+    const std::vector<Setup> setups = {
+        {"1:1", 1, 1},
+        {"1:" + std::to_string(n), 1, n},
+        {std::to_string(n) + ":" + std::to_string(n), n, n},
+    };
+
+    std::cout << items << " items, queue size " << queueSize << ", Mitems/s (median of 5 runs)" << std::endl;
+    std::cout << std::left << std::setw(10) << "P:C" << std::setw(18) << "ThreadSafeQueue" << std::setw(18) << "LockFreeQueue" << "Speedup" << std::endl;
+    for (const auto& setup : setups) {
+        double locked = run<hva::hvaThreadSafeQueue_t<Item>>(setup.producers, setup.consumers, items, queueSize);
+        double lockFree = run<hva::hvaLockFreeQueue_t<Item>>(setup.producers, setup.consumers, items, queueSize);
+        std::cout << std::left << std::setw(10) << setup.name << std::fixed << std::setprecision(2) <<
+            std::setw(18) << locked << std::setw(18) << lockFree << lockFree / locked << "x" << std::endl;
+    }
+    return 0;
+}
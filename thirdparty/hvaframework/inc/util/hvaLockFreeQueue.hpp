@@ -0,0 +1,421 @@
+//
+//Copyright (C) 2020 Intel Corporation
+//
+//SPDX-License-Identifier: MIT
+//
+
+#ifndef HVA_HVALOCKFREEQUEUE_HPP
+#define HVA_HVALOCKFREEQUEUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace hva
+{
+
+namespace detail
+{
+
+// Sleeps while *addr == expected, wakes up on futexWake*() of the same address or spuriously
+inline void futexWait(std::atomic<uint32_t>* addr, uint32_t expected);
+inline void futexWakeOne(std::atomic<uint32_t>* addr);
+inline void futexWakeAll(std::atomic<uint32_t>* addr);
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+#if defined(_WIN32)
+
+inline void futexWait(std::atomic<uint32_t>* addr, uint32_t expected)
+{
+    WaitOnAddress(reinterpret_cast<volatile VOID*>(addr), &expected, sizeof(expected), INFINITE);
+}
+
+inline void futexWakeOne(std::atomic<uint32_t>* addr)
+{
+    WakeByAddressSingle(reinterpret_cast<PVOID>(addr));
+}
+
+inline void futexWakeAll(std::atomic<uint32_t>* addr)
+{
+    WakeByAddressAll(reinterpret_cast<PVOID>(addr));
+}
+
+#elif defined(__linux__)
+
+inline void futexWait(std::atomic<uint32_t>* addr, uint32_t expected)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+inline void futexWakeOne(std::atomic<uint32_t>* addr)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+inline void futexWakeAll(std::atomic<uint32_t>* addr)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+// No address based waiting on this platform, parked threads share one condition variable
+struct futexFallback_t
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    static futexFallback_t& instance()
+    {
+        static futexFallback_t fallback;
+        return fallback;
+    }
+};
+
+inline void futexWait(std::atomic<uint32_t>* addr, uint32_t expected)
+{
+    futexFallback_t& fallback = futexFallback_t::instance();
+    std::unique_lock<std::mutex> lk(fallback.mutex);
+    fallback.cv.wait(lk, [&]{return addr->load() != expected;});
+}
+
+inline void futexWakeOne(std::atomic<uint32_t>* addr)
+{
+    futexWakeAll(addr);
+}
+
+inline void futexWakeAll(std::atomic<uint32_t>* addr)
+{
+    futexFallback_t& fallback = futexFallback_t::instance();
+    {
+        std::lock_guard<std::mutex> lk(fallback.mutex);
+    }
+    fallback.cv.notify_all();
+}
+
+#endif
+
+// Lets threads sleep until a condition they checked may have changed, without a lock on the
+// fast path. A waiter reads the epoch, registers, re-checks its condition and sleeps only if
+// the epoch did not move. A notifier changes the state first and bumps the epoch only when
+// somebody is registered, so a push or pop without sleepers costs one atomic load.
+class hvaEventCount_t
+{
+public:
+    hvaEventCount_t(): m_epoch(0), m_waiters(0) {}
+
+    uint32_t prepareWait()
+    {
+        uint32_t epoch = m_epoch.load(std::memory_order_acquire);
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        return epoch;
+    }
+
+    void cancelWait()
+    {
+        m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void wait(uint32_t epoch)
+    {
+        futexWait(&m_epoch, epoch);
+        m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void notifyOne()
+    {
+        if (hasWaiters())
+        {
+            m_epoch.fetch_add(1, std::memory_order_release);
+            futexWakeOne(&m_epoch);
+        }
+    }
+
+    void notifyAll()
+    {
+        if (hasWaiters())
+        {
+            m_epoch.fetch_add(1, std::memory_order_release);
+            futexWakeAll(&m_epoch);
+        }
+    }
+
+private:
+    // Read-modify-write orders the read after the state change of the notifier, the same way
+    // prepareWait() orders registration before the re-check of the waiter
+    bool hasWaiters()
+    {
+        return m_waiters.fetch_add(0, std::memory_order_seq_cst) != 0;
+    }
+
+    std::atomic<uint32_t> m_epoch;
+    std::atomic<uint32_t> m_waiters;
+};
+
+} // namespace detail
+
+// Bounded multi-producer multi-consumer queue with the API of hvaThreadSafeQueue_t.
+// Slots form a ring, each with a sequence number telling whether it is ready to be written
+// or read at the current lap, so producers and consumers only race on their own cursor with
+// a CAS. Blocking push and pop park the thread on an event count instead of spinning.
+// Capacity is rounded up to a power of two. As in hvaThreadSafeQueue_t, after close() every
+// call returns false and values still queued are destroyed with the queue.
+template <typename T>
+class hvaLockFreeQueue_t {
+public:
+
+    hvaLockFreeQueue_t(std::size_t maxSize=1024)
+    : m_mask(roundUpPow2(maxSize) - 1), m_cells(m_mask + 1), m_close(false), m_enqueuePos(0), m_dequeuePos(0)
+    {
+        for (std::size_t i = 0; i <= m_mask; ++i)
+        {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    };
+    hvaLockFreeQueue_t(const hvaLockFreeQueue_t& ) = delete;
+    hvaLockFreeQueue_t& operator =(const hvaLockFreeQueue_t& ) = delete;
+
+    ~hvaLockFreeQueue_t()
+    {
+        std::size_t end = m_enqueuePos.load(std::memory_order_acquire);
+        for (std::size_t pos = m_dequeuePos.load(std::memory_order_acquire); pos != end; ++pos)
+        {
+            reinterpret_cast<T*>(&m_cells[pos & m_mask].storage)->~T();
+        }
+    }
+
+    bool push(T value)
+    {
+        for (unsigned attempt = 0; ; ++attempt)
+        {
+            if (m_close.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (enqueue(value))
+            {
+                m_notEmpty.notifyOne();
+                return true;
+            }
+            if (attempt < m_yieldAttempts)
+            {
+                // A consumer is likely to free a slot within a few time slices, which is cheaper than parking
+                std::this_thread::yield();
+                continue;
+            }
+            // Retried after registering, so a pop completing in between either is seen here or wakes us up
+            uint32_t epoch = m_notFull.prepareWait();
+            if (m_close.load(std::memory_order_acquire))
+            {
+                m_notFull.cancelWait();
+                return false;
+            }
+            if (enqueue(value))
+            {
+                m_notFull.cancelWait();
+                m_notEmpty.notifyOne();
+                return true;
+            }
+            m_notFull.wait(epoch);
+        }
+    }
+
+    bool tryPush(T value)
+    {
+        if (m_close.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        if (!enqueue(value))
+        {
+            return false;
+        }
+        m_notEmpty.notifyOne();
+        return true;
+    }
+
+    bool pop(T& value)
+    {
+        for (unsigned attempt = 0; ; ++attempt)
+        {
+            if (m_close.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (dequeue(value))
+            {
+                m_notFull.notifyOne();
+                return true;
+            }
+            if (attempt < m_yieldAttempts)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t epoch = m_notEmpty.prepareWait();
+            if (m_close.load(std::memory_order_acquire))
+            {
+                m_notEmpty.cancelWait();
+                return false;
+            }
+            if (dequeue(value))
+            {
+                m_notEmpty.cancelWait();
+                m_notFull.notifyOne();
+                return true;
+            }
+            m_notEmpty.wait(epoch);
+        }
+    }
+
+    bool tryPop(T& value)
+    {
+        if (m_close.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        if (!dequeue(value))
+        {
+            return false;
+        }
+        m_notFull.notifyOne();
+        return true;
+    }
+
+    // Snapshot, may be stale by the time it returns
+    bool empty() const
+    {
+        return m_dequeuePos.load(std::memory_order_acquire) >= m_enqueuePos.load(std::memory_order_acquire);
+    }
+
+    void close()
+    {
+        m_close.store(true, std::memory_order_release);
+        m_notEmpty.notifyAll();
+        m_notFull.notifyAll();
+        return;
+    }
+
+private:
+    struct cell_t
+    {
+        std::atomic<std::size_t> seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    static std::size_t roundUpPow2(std::size_t size)
+    {
+        if (size == 0 || size > (SIZE_MAX >> 1) + 1)
+        {
+            throw std::invalid_argument("hvaLockFreeQueue_t size should be in [1, SIZE_MAX / 2 + 1]");
+        }
+        std::size_t pow2 = 1;
+        while (pow2 < size)
+        {
+            pow2 <<= 1;
+        }
+        return pow2;
+    }
+
+    // Moves value in on success, leaves it untouched otherwise
+    bool enqueue(T& value)
+    {
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        cell_t* cell;
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // The slot still holds the value of the previous lap
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        new (&cell->storage) T(std::move(value));
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool dequeue(T& value)
+    {
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        cell_t* cell;
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // The slot was not written at this lap yet
+                return false;
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        T* stored = reinterpret_cast<T*>(&cell->storage);
+        value = std::move(*stored);
+        stored->~T();
+        cell->seq.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    static const unsigned m_yieldAttempts = 16;  // Yields before a blocking call parks the thread
+
+    const std::size_t m_mask;
+    std::vector<cell_t> m_cells;
+    std::atomic<bool> m_close;
+    detail::hvaEventCount_t m_notEmpty;
+    detail::hvaEventCount_t m_notFull;
+    // Cursors on their own cache lines, so producers and consumers don't invalidate each other
+    alignas(64) std::atomic<std::size_t> m_enqueuePos;
+    alignas(64) std::atomic<std::size_t> m_dequeuePos;
+};
+
+} // namespace hva
+
+#endif //#ifndef HVA_HVALOCKFREEQUEUE_HPP
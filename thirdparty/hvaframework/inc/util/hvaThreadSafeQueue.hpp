@@ -35,7 +35,7 @@ public:
         {
             return false;
         }   
-        m_queue.push_back(std::move(value));
+        m_queue.push(std::move(value));
         m_cv_empty.notify_one();
         return true;
     }
@@ -51,7 +51,7 @@ public:
         {
             return false;
         }
-        m_queue.push_back(std::move(value));
+        m_queue.push(std::move(value));
         m_cv_empty.notify_one();
         return true;
     }